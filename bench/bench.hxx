@@ -0,0 +1,288 @@
+///	@file
+///	@brief		Harness of benchmarks.
+///	@details	It measures operations in one or more threads,
+///				and reports the results as text, JSON, or CSV to compare them across releases.
+///				Each benchmark accepts the following options:
+///				- --format=text|json|csv	Format of results; text by default.
+///				- --output=path				File of results; standard output by default.
+///	@pre		ISO/IEC 14882:2017
+///	@author		Mura
+///	@copyright	(C) 2018-, Mura. All rights reserved.
+
+#ifndef xxx_BENCH_HXX_
+#define xxx_BENCH_HXX_
+
+#include <xxx/xxx.hxx>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+//	Prevents the optimizer from removing the result.
+template<typename T>
+T volatile	sink_s;
+
+template<typename T>
+void
+sink(T const& t)
+{
+	sink_s<T>	= t;
+}
+
+//	Result of a benchmark.
+struct result_t
+{
+	std::string		name;				//< Name of the benchmark.
+	std::size_t		threads{ 1u };		//< Number of threads.
+	std::uint64_t	operations{};		//< Number of operations of all the threads.
+	double			elapsed_ns{};		//< Elapsed time in nanoseconds.
+	std::uint64_t	bytes{};			//< Number of processed bytes, or zero.
+	double			p50_ns{};			//< Median latency of an operation, or zero if it is not sampled.
+	double			p99_ns{};			//< 99th percentile latency of an operation, or zero if it is not sampled.
+	double			max_ns{};			//< Maximum latency of an operation, or zero if it is not sampled.
+
+	double	ns_per_op() const noexcept		{ return operations == 0u ? 0.0 : elapsed_ns / static_cast<double>(operations);	}
+	double	ops_per_sec() const noexcept	{ return elapsed_ns <= 0.0 ? 0.0 : static_cast<double>(operations) * 1e9 / elapsed_ns;	}
+	double	mb_per_sec() const noexcept		{ return elapsed_ns <= 0.0 ? 0.0 : static_cast<double>(bytes) * 1e3 / elapsed_ns;	}
+};
+
+//	Reporter of results.
+//	Text results are printed as soon as they are measured; JSON and CSV ones are written at destruction.
+class reporter_t
+{
+public:
+	//	Adds a result.
+	//	@param[in]		result		Result.
+	void
+	add(result_t const& result)
+	{
+		results_.push_back(result);
+		if(format_ == format_t::Text)
+		{
+			write_text_(out(), result);
+		}
+	}
+
+	//	Constructor.
+	//	@param[in]		argc		Number of arguments.
+	//	@param[in]		argv		Arguments.
+	//	@param[in]		suite		Name of the suite.
+	//	@exception		std::invalid_argument	An argument is unknown.
+	reporter_t(int argc, char* argv[], std::string const& suite) : suite_{ suite }, format_{ format_t::Text }, file_{}, results_{}
+	{
+		for(int i{ 1 }; i < argc; ++i)
+		{
+			std::string_view const	arg{ argv[i] };
+			if(arg == "--format=text")		{ format_	= format_t::Text;	}
+			else if(arg == "--format=json")	{ format_	= format_t::Json;	}
+			else if(arg == "--format=csv")	{ format_	= format_t::Csv;	}
+			else if(arg.substr(0u, 9u) == "--output=")
+			{
+				file_.open(std::string(arg.substr(9u)));
+				if( ! file_)
+				{
+					throw std::invalid_argument(std::string(arg));
+				}
+			}
+			else
+			{
+				throw std::invalid_argument(std::string(arg));
+			}
+		}
+		if(format_ == format_t::Text)
+		{
+			out() << "---[" << suite_ << "]---" << std::endl;
+		}
+	}
+	//	Destructor.
+	~reporter_t()
+	{
+		if(format_ == format_t::Json)
+		{
+			write_json_(out());
+		}
+		else if(format_ == format_t::Csv)
+		{
+			write_csv_(out());
+		}
+	}
+private:
+	reporter_t(reporter_t const&)						= delete;
+	reporter_t const&	operator =(reporter_t const&)	= delete;
+private:
+	enum class format_t
+	{
+		Text,
+		Json,
+		Csv,
+	};
+
+	std::ostream&	out() noexcept	{ return file_.is_open() ? static_cast<std::ostream&>(file_) : std::cout;	}
+
+	static void
+	write_text_(std::ostream& os, result_t const& r)
+	{
+		os << r.name << '\t' << r.threads << " thread(s)\t" << std::fixed << std::setprecision(1) << r.ns_per_op() << " ns/op";
+		if(0u < r.bytes)
+		{
+			os << '\t' << r.mb_per_sec() << " MB/s";
+		}
+		if(0.0 < r.max_ns)
+		{
+			os << "\tp50=" << r.p50_ns << " p99=" << r.p99_ns << " max=" << r.max_ns << " ns";
+		}
+		os << std::defaultfloat << std::endl;
+	}
+	void
+	write_json_(std::ostream& os) const
+	{
+		os << "{\"suite\":\"" << suite_ << "\",\"version\":" << xxx_version
+			<< ",\"hardware_concurrency\":" << std::thread::hardware_concurrency() << ",\"results\":[";
+		bool	first{ true };
+		for(auto const& r : results_)
+		{
+			os << (first ? "" : ",") << "\n{\"name\":\"" << r.name << "\",\"threads\":" << r.threads << ",\"operations\":" << r.operations
+				<< ",\"ns_per_op\":" << r.ns_per_op() << ",\"ops_per_sec\":" << r.ops_per_sec() << ",\"mb_per_sec\":" << r.mb_per_sec()
+				<< ",\"p50_ns\":" << r.p50_ns << ",\"p99_ns\":" << r.p99_ns << ",\"max_ns\":" << r.max_ns << "}";
+			first	= false;
+		}
+		os << "\n]}" << std::endl;
+	}
+	void
+	write_csv_(std::ostream& os) const
+	{
+		os << "suite,name,threads,operations,ns_per_op,ops_per_sec,mb_per_sec,p50_ns,p99_ns,max_ns\n";
+		for(auto const& r : results_)
+		{
+			os << suite_ << ',' << r.name << ',' << r.threads << ',' << r.operations << ',' << r.ns_per_op() << ',' << r.ops_per_sec()
+				<< ',' << r.mb_per_sec() << ',' << r.p50_ns << ',' << r.p99_ns << ',' << r.max_ns << '\n';
+		}
+		os.flush();
+	}
+private:
+	std::string				suite_;		//< Name of the suite.
+	format_t				format_;	//< Format of results.
+	std::ofstream			file_;		//< File of results, or closed for standard output.
+	std::vector<result_t>	results_;	//< Results.
+};
+
+//	Measures operations in the current thread.
+//	@param[in,out]	reporter	Reporter.
+//	@param[in]		name		Name of the benchmark.
+//	@param[in]		count		Number of operations which @p f runs.
+//	@param[in]		f			Function object to run the operations.
+//	@param[in]		bytes		Number of bytes which @p f processes.
+template<typename F>
+void
+measure(reporter_t& reporter, std::string const& name, std::uint64_t count, F const& f, std::uint64_t bytes=0u)
+{
+	auto const	start{ std::chrono::steady_clock::now() };
+	f();
+	auto const	elapsed{ std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start) };
+	reporter.add(result_t{ name, 1u, count, elapsed.count(), bytes });
+}
+
+//	Measures operations in threads which start at once.
+//	If @p sample is true, the latency of each operation is measured as well,
+//	which includes the overhead of reading the clock.
+//	@param[in,out]	reporter	Reporter.
+//	@param[in]		name		Name of the benchmark.
+//	@param[in]		threads		Number of threads.
+//	@param[in]		count		Number of operations per thread.
+//	@param[in]		f			Function object to run an operation, which takes the index of thread and operation.
+//	@param[in]		sample		Whether the latency of each operation is measured or not.
+template<typename F>
+void
+measure_threads(reporter_t& reporter, std::string const& name, std::size_t threads, std::uint64_t count, F const& f, bool sample=false)
+{
+	std::atomic<std::size_t>				ready{};
+	std::atomic<bool>						go{};
+	std::vector<std::vector<std::int64_t>>	latencies(threads);
+	std::vector<std::thread>				workers;
+	for(std::size_t t{}; t < threads; ++t)
+	{
+		workers.emplace_back([&, t]()
+		{
+			auto&	latency{ latencies[t] };
+			latency.reserve(sample ? count : 0u);
+			++ready;
+			while( ! go.load(std::memory_order_acquire))
+			{
+				std::this_thread::yield();
+			}
+			for(std::uint64_t n{}; n < count; ++n)
+			{
+				if(sample)
+				{
+					auto const	start{ std::chrono::steady_clock::now() };
+					f(t, n);
+					latency.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+				}
+				else
+				{
+					f(t, n);
+				}
+			}
+		});
+	}
+	while(ready.load() < threads)
+	{
+		std::this_thread::yield();
+	}
+	auto const	start{ std::chrono::steady_clock::now() };
+	go.store(true, std::memory_order_release);
+	for(auto& worker : workers)
+	{
+		worker.join();
+	}
+	auto const	elapsed{ std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start) };
+
+	result_t	result{ name, threads, threads * count, elapsed.count() };
+	if(sample)
+	{
+		std::vector<std::int64_t>	all;
+		for(auto const& latency : latencies)
+		{
+			all.insert(std::end(all), std::begin(latency), std::end(latency));
+		}
+		if( ! all.empty())
+		{
+			std::sort(std::begin(all), std::end(all));
+			auto const	at{ [&all](double q) { return static_cast<double>(all[std::min(all.size() - 1u, static_cast<std::size_t>(q * static_cast<double>(all.size())))]); } };
+			result.p50_ns	= at(0.50);
+			result.p99_ns	= at(0.99);
+			result.max_ns	= static_cast<double>(all.back());
+		}
+	}
+	reporter.add(result);
+}
+
+//	Gets numbers of threads to measure, i.e., powers of two up to the hardware concurrency.
+//	@param[in]		limit		Maximum number of threads.
+//	@return		Numbers of threads.
+inline std::vector<std::size_t>
+thread_counts(std::size_t limit=8u)
+{
+	auto const	hardware{ std::max<std::size_t>(1u, std::min<std::size_t>(limit, std::thread::hardware_concurrency())) };
+	std::vector<std::size_t>	counts;
+	for(std::size_t n{ 1u }; n <= hardware; n *= 2u)
+	{
+		counts.push_back(n);
+	}
+	return counts;
+}
+
+}	// namespace bench
+
+#endif	// xxx_BENCH_HXX_
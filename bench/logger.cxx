@@ -0,0 +1,220 @@
+///	@file
+///	@brief		Benchmark of logger.
+///	@details	It measures the throughput and the latency of logging into each sink in threads,
+///				the cost of calls at disabled levels or over rate limits, and the overhead of tracer_t.
+///	@pre		ISO/IEC 14882:2017
+///	@author		Mura
+///	@copyright	(C) 2018-, Mura. All rights reserved.
+
+#include "bench.hxx"
+
+#include <xxx/logger.hxx>
+
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+#if defined(xxx_posix) && ! defined(xxx_standard_cpp_only)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+//	Stream buffer which discards everything like /dev/null.
+class null_buffer_t : public std::streambuf
+{
+protected:
+	int_type			overflow(int_type ch) override							{ return traits_type::not_eof(ch);	}
+	std::streamsize		xsputn(char const*, std::streamsize size) override		{ return size;	}
+};
+
+#if defined(xxx_posix) && ! defined(xxx_standard_cpp_only)
+
+//	Stand-in of syslog daemon, which receives and discards datagrams.
+class syslogd_t
+{
+public:
+	explicit syslogd_t(std::string const& path) : socket_{ ::socket(AF_UNIX, SOCK_DGRAM, 0) }, path_{ path }, stopping_{}, thread_{}
+	{
+		::unlink(path_.c_str());
+		::sockaddr_un	address{};
+		address.sun_family	= AF_UNIX;
+		std::strncpy(address.sun_path, path_.c_str(), sizeof(address.sun_path) - 1u);
+		if(::bind(socket_, reinterpret_cast<::sockaddr const*>(&address), sizeof(address)) != 0)
+		{
+			throw std::runtime_error(path_);
+		}
+		::timeval const	timeout{ 0, 100'000 };
+		::setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		thread_	= std::thread{ [this]()
+		{
+			char	buffer[2048];
+			while( ! stopping_.load())
+			{
+				::recv(socket_, buffer, sizeof(buffer), 0);
+			}
+		} };
+	}
+	~syslogd_t()
+	{
+		stopping_.store(true);
+		thread_.join();
+		::close(socket_);
+		::unlink(path_.c_str());
+	}
+private:
+	int					socket_;
+	std::string			path_;
+	std::atomic<bool>	stopping_;
+	std::thread			thread_;
+};
+
+#endif
+
+//	Measures throughput and latency of logging into a configured logger.
+template<typename C>
+void
+bench_sink(bench::reporter_t& reporter, std::string const& name, std::uint64_t total, C const& configure)
+{
+	for(auto const threads : bench::thread_counts())
+	{
+		for(auto const sample : { false, true })
+		{
+			xxx::log::add_logger("bench", xxx::log::level_t::Info, "", "", false);
+			auto&	logger	= xxx::log::logger("bench");
+			configure(logger);
+			bench::measure_threads(reporter, name + (sample ? "/latency" : "/throughput"), threads, total / threads,
+				[&logger](std::size_t t, std::uint64_t n) { logger.info(xxx_logpos, "thread:", t, " count:", n, " value:", 1.5); }, sample);
+			xxx::log::remove_logger("bench");		// writes the queued lines.
+		}
+	}
+}
+
+void
+bench_sinks(bench::reporter_t& reporter)
+{
+	constexpr std::uint64_t	total{ 200'000u };
+
+	std::filesystem::path const	path{ "bench_logger.log" };
+	auto const	file{ [&path](xxx::log::logger_t& logger) { std::filesystem::remove(path); logger.set_path(path); } };
+	bench_sink(reporter, "file", total, file);
+	bench_sink(reporter, "file_async", total, [&file](xxx::log::logger_t& logger) { file(logger); logger.set_async(64u * 1024u, xxx::log::overflow_t::Block); });
+	bench_sink(reporter, "file_batch", total, [&file](xxx::log::logger_t& logger) { file(logger); logger.set_batch(64u * 1024u); });
+	bench_sink(reporter, "file_json", total, [&file](xxx::log::logger_t& logger) { file(logger); logger.set_format(xxx::log::format_t::Json); });
+	bench_sink(reporter, "file_binary", total, [&file](xxx::log::logger_t& logger) { file(logger); logger.set_binary(true); });
+	std::filesystem::remove(path);
+
+	null_buffer_t	null_buffer;
+	auto const		clog{ std::clog.rdbuf(&null_buffer) };
+	bench_sink(reporter, "console", total, [](xxx::log::logger_t& logger) { logger.set_console(true); });
+	std::clog.rdbuf(clog);
+
+#if defined(xxx_posix) && ! defined(xxx_standard_cpp_only)
+	std::string const	socket{ "bench_syslog.sock" };
+	syslogd_t const		syslogd{ socket };
+	bench_sink(reporter, "syslog", total / 4u, [&socket](xxx::log::logger_t& logger)
+	{
+		logger.set_logger("bench");
+		logger.set_syslog_option(xxx::log::syslog_option_t{ xxx::log::facility_t::User, socket });
+	});
+#endif
+}
+
+void
+bench_disabled(bench::reporter_t& reporter)
+{
+	constexpr std::uint64_t	count{ 10'000'000u };
+
+	xxx::log::add_logger("bench", xxx::log::level_t::Info, "", "", false);
+	auto&	logger	= xxx::log::logger("bench");
+	bench::measure(reporter, "disabled/log", count, [&logger]()
+	{
+		for(std::uint64_t n{}; n < count; ++n)
+		{
+			logger.debug(xxx_logpos, "count:", n, " value:", 1.5);
+		}
+	});
+	bench::measure(reporter, "disabled/macro", count, [&logger]()
+	{
+		for(std::uint64_t n{}; n < count; ++n)
+		{
+			xxx_log(logger, xxx::log::level_t::Debug, "count:", n, " value:", 1.5);
+		}
+	});
+	bench::measure(reporter, "disabled/recorder", count / 10u, [&logger]()
+	{
+		logger.set_recorder(xxx::log::level_t::Debug);
+		for(std::uint64_t n{}; n < count / 10u; ++n)
+		{
+			logger.debug(xxx_logpos, "count:", n, " value:", 1.5);
+		}
+		logger.set_recorder(xxx::log::level_t::Silent);
+	});
+	bench::measure(reporter, "disabled/rate_limited", count / 10u, [&logger]()
+	{
+		logger.set_rate_limit(xxx::log::level_t::Info, xxx::log::rate_limit_t{ 1u, std::chrono::hours{ 1 } });
+		for(std::uint64_t n{}; n < count / 10u; ++n)
+		{
+			logger.info(xxx_logpos, "count:", n, " value:", 1.5);
+		}
+		logger.set_rate_limit(xxx::log::level_t::Info, xxx::log::rate_limit_t{});
+	});
+	xxx::log::remove_logger("bench");
+}
+
+void
+bench_tracer(bench::reporter_t& reporter)
+{
+	constexpr std::uint64_t	count{ 1'000'000u };
+
+	std::filesystem::path const	path{ "bench_tracer.log" };
+	std::filesystem::remove(path);
+	xxx::log::add_logger("bench", xxx::log::level_t::Info, path, "", false);
+	auto&	logger	= xxx::log::logger("bench");
+
+	bench::measure(reporter, "tracer/disabled", count, [&logger]()
+	{
+		for(std::uint64_t n{}; n < count; ++n)
+		{
+			xxx::log::tracer_t	tracer{ logger, xxx_logpos, n };
+		}
+	});
+	logger.set_profiling(true);
+	bench::measure(reporter, "tracer/profiling", count, [&logger]()
+	{
+		for(std::uint64_t n{}; n < count; ++n)
+		{
+			xxx::log::tracer_t	tracer{ logger, xxx_logpos, n };
+		}
+	});
+	logger.set_profiling(false);
+	bench::measure(reporter, "tracer/enabled", count / 10u, [&logger]()
+	{
+		for(std::uint64_t n{}; n < count / 10u; ++n)
+		{
+			xxx::log::tracer_t	tracer{ logger, xxx::log::level_t::Info, xxx_logpos, n };
+		}
+	});
+	xxx::log::remove_logger("bench");
+	std::filesystem::remove(path);
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+	bench::reporter_t	reporter{ argc, argv, "logger" };
+
+	bench_disabled(reporter);
+	bench_tracer(reporter);
+	bench_sinks(reporter);
+}
+catch(std::exception const& e)
+{
+	std::cerr << e.what() << std::endl;
+	return 1;
+}
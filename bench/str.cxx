@@ -0,0 +1,102 @@
+///	@file
+///	@brief		Benchmark of string utilities.
+///	@details	It compares lexical_cast with the former stream based implementation,
+///				and trim with trim_view.
+///	@pre		ISO/IEC 14882:2017
+///	@author		Mura
+///	@copyright	(C) 2018-, Mura. All rights reserved.
+
+#include "bench.hxx"
+
+#include <xxx/str.hxx>
+
+#include <exception>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//	The former implementation of lexical_cast.
+template<typename T>
+T
+stream_cast(std::string const& str)
+{
+	std::istringstream	iss{ str };
+	T	t{};
+	if ( ! (iss >> t))
+	{
+		throw std::invalid_argument(__func__);
+	}
+	return t;
+}
+
+using bench::sink;
+
+template<typename T>
+void
+bench_cast(bench::reporter_t& reporter, std::string const& type, std::vector<std::string> const& fields)
+{
+	bench::measure(reporter, type + "/stream_cast", fields.size(), [&fields]() { for (auto const& f : fields)	sink(stream_cast<T>(f)); });
+	bench::measure(reporter, type + "/lexical_cast", fields.size(), [&fields]() { for (auto const& f : fields)	sink(xxx::lexical_cast<T>(f)); });
+	bench::measure(reporter, type + "/try_lexical_cast", fields.size(), [&fields]() { for (auto const& f : fields)	sink(*xxx::try_lexical_cast<T>(f)); });
+
+	std::string	joined;
+	for (auto const& f : fields)
+	{
+		joined.append(f).push_back(',');
+	}
+	joined.pop_back();
+	std::vector<T>	values;
+	values.reserve(fields.size());
+	bench::measure(reporter, type + "/try_lexical_cast_list", fields.size(), [&joined, &values]() { sink(xxx::try_lexical_cast_list(joined, ',', values)); }, joined.size());
+}
+
+void
+bench_trim(bench::reporter_t& reporter, std::vector<std::string> const& fields)
+{
+	std::vector<std::string>	padded;
+	padded.reserve(fields.size());
+	for (auto const& f : fields)
+	{
+		padded.push_back("  " + f + " \t");
+	}
+	bench::measure(reporter, "trim", padded.size(), [&padded]() { for (auto const& f : padded)	sink(xxx::trim(f).size()); });
+	bench::measure(reporter, "trim_view", padded.size(), [&padded]() { for (auto const& f : padded)	sink(xxx::trim_view(f).size()); });
+
+	std::string	joined;
+	for (auto const& f : padded)
+	{
+		joined.append(f).push_back(',');
+	}
+	bench::measure(reporter, "split", padded.size(), [&joined]() { for (auto const field : xxx::split(joined, ','))	sink(field.size()); }, joined.size());
+	bench::measure(reporter, "tokenize", padded.size(), [&joined]() { for (auto const token : xxx::tokenize(joined))	sink(token.size()); }, joined.size());
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+	bench::reporter_t	reporter{ argc, argv, "str" };
+
+	constexpr std::size_t	count{ 1'000'000u };
+
+	std::mt19937	random{ 12345u };
+	std::vector<std::string>	ints, doubles;
+	ints.reserve(count);
+	doubles.reserve(count);
+	for (std::size_t i{}; i < count; ++i)
+	{
+		ints.push_back(std::to_string(static_cast<int>(random())));
+		doubles.push_back(std::to_string(static_cast<double>(random()) / 1024.0));
+	}
+
+	bench_cast<int>(reporter, "int", ints);
+	bench_cast<double>(reporter, "double", doubles);
+	bench_trim(reporter, doubles);
+}
+catch(std::exception const& e)
+{
+	std::cerr << e.what() << std::endl;
+	return 1;
+}
@@ -0,0 +1,117 @@
+///	@file
+///	@brief		Benchmark of UNICODE.
+///	@details	It measures the throughput of conversions and incremental transcoding
+///				on ASCII, CJK, and emoji-heavy corpora with each instruction set.
+///	@pre		ISO/IEC 14882:2020
+///	@author		Mura
+///	@copyright	(C) 2018-, Mura. All rights reserved.
+
+#include "bench.hxx"
+
+#include <xxx/uc.hxx>
+
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using bench::sink;
+
+//	Makes a corpus of random code points.
+//	@param[in]		first		The first code point of the main range.
+//	@param[in]		last		The last code point of the main range.
+//	@param[in]		ascii		Ratio of ASCII characters mixed into it.
+//	@return		Corpus.
+std::u32string
+make_corpus(char32_t first, char32_t last, double ascii)
+{
+	constexpr std::size_t	size{ 1u << 20 };
+
+	std::mt19937							random{ 12345u };
+	std::uniform_int_distribution<char32_t>	main{ first, last };
+	std::uniform_int_distribution<char32_t>	printable{ U' ', U'~' };
+	std::bernoulli_distribution				mixed{ ascii };
+	std::u32string	corpus;
+	corpus.reserve(size);
+	while(corpus.size() < size)
+	{
+		corpus.push_back(mixed(random) ? printable(random) : main(random));
+	}
+	return corpus;
+}
+
+//	Measures conversions of a corpus.
+void
+bench_corpus(bench::reporter_t& reporter, std::string const& name, std::u32string const& corpus)
+{
+	namespace uc	= xxx::uc;
+
+	constexpr int	repeat{ 10 };
+
+	auto const	u8{ uc::to_u8string(corpus) };
+	auto const	u16{ uc::to_u16string(corpus) };
+	auto const	bytes{ [](auto const& str) { return static_cast<std::uint64_t>(str.size() * sizeof(str[0]) * repeat); } };
+
+	bench::measure(reporter, name + "/u8_to_u16", u8.size() * repeat, [&u8]() { for(int i{}; i < repeat; ++i)	sink(uc::to_u16string(u8).size()); }, bytes(u8));
+	bench::measure(reporter, name + "/u8_to_u32", u8.size() * repeat, [&u8]() { for(int i{}; i < repeat; ++i)	sink(uc::to_u32string(u8).size()); }, bytes(u8));
+	bench::measure(reporter, name + "/u16_to_u8", u16.size() * repeat, [&u16]() { for(int i{}; i < repeat; ++i)	sink(uc::to_u8string(u16).size()); }, bytes(u16));
+	bench::measure(reporter, name + "/u32_to_u8", corpus.size() * repeat, [&corpus]() { for(int i{}; i < repeat; ++i)	sink(uc::to_u8string(corpus).size()); }, bytes(corpus));
+	bench::measure(reporter, name + "/u32_to_u16", corpus.size() * repeat, [&corpus]() { for(int i{}; i < repeat; ++i)	sink(uc::to_u16string(corpus).size()); }, bytes(corpus));
+
+	// transcodes chunks into a fixed buffer as streams do.
+	bench::measure(reporter, name + "/transcoder_u8_to_u16", u8.size() * repeat, [&u8]()
+	{
+		constexpr std::size_t	chunk{ 4096u };
+		char16_t	buffer[chunk];
+		for(int i{}; i < repeat; ++i)
+		{
+			uc::transcoder_t<char8_t, char16_t>	transcoder;
+			std::size_t	total{};
+			for(std::u8string_view input{ u8 }; ! input.empty(); )
+			{
+				auto const	[consumed, produced]{ transcoder.convert(input.substr(0u, chunk), buffer, std::size(buffer)) };
+				input.remove_prefix(consumed);
+				total	+= produced;
+			}
+			sink(total + transcoder.finish(buffer, std::size(buffer)));
+		}
+	}, bytes(u8));
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+	namespace uc	= xxx::uc;
+
+	bench::reporter_t	reporter{ argc, argv, "uc" };
+
+	std::vector<std::pair<std::string, std::u32string>> const	corpora{
+		{ "ascii",	make_corpus(U' ', U'~', 1.0) },
+		{ "cjk",	make_corpus(U'\u4E00', U'\u9FFF', 0.1) },
+		{ "emoji",	make_corpus(U'\U0001F300', U'\U0001F64F', 0.3) },
+	};
+	std::vector<std::pair<std::string, uc::simd_t>> const	simds{
+		{ "scalar",	uc::simd_t::Scalar },
+		{ "sse2",	uc::simd_t::SSE2 },
+		{ "avx2",	uc::simd_t::AVX2 },
+	};
+	for(auto const& [simd_name, simd] : simds)
+	{
+		if(static_cast<int>(uc::supported_simd()) < static_cast<int>(simd))
+		{
+			continue;
+		}
+		uc::set_simd(simd);
+		for(auto const& [corpus_name, corpus] : corpora)
+		{
+			bench_corpus(reporter, simd_name + "/" + corpus_name, corpus);
+		}
+	}
+}
+catch(std::exception const& e)
+{
+	std::cerr << e.what() << std::endl;
+	return 1;
+}
@@ -10,13 +10,27 @@
 #include <xxx/xxx.hxx>
 
 #include <unordered_map>
+#include <map>
 #include <memory>
+#include <utility>
+#include <functional>
 #include <iostream>
-#include <fstream>
-#include <sstream>
-#include <iomanip>
 #include <chrono>
+#include <charconv>
 #include <ctime>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <system_error>
+#include <vector>
+#include <unordered_set>
+#include <deque>
+#include <tuple>
+#include <numeric>
+#include <cmath>
 
 #if defined(xxx_standard_cpp_only)
 
@@ -30,195 +44,3787 @@
 #define STRICT
 #include <Windows.h>
 #elif defined(xxx_posix)
-#include <syslog.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 #else
 #error "No platform is specified."
 #endif
 
+#if ! defined(xxx_standard_cpp_only) && ! defined(xxx_win32) && defined(xxx_posix)
+#define	xxx_syslog_socket
+#endif
+
+#if ! defined(xxx_standard_cpp_only) && (defined(__SSE2__) || defined(_M_X64))
+#define	xxx_json_sse2
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
 //	@name	xxx
 namespace xxx {
 namespace log {
 
 #if ! defined(xxx_no_logging)
 
-inline std::string
-strip(std::string const& str)
+inline std::string_view
+strip(std::string_view str)
 {
 	auto const	pos{ str.find_last_of("\\/") };
-	if (pos == std::string::npos)
+	if (pos == std::string_view::npos)
 	{
 		return str;
 	}
 	return str.substr(pos+1);
 }
 
-void
-logger_t::log_(level_t level, std::optional<sl::source_location> const& pos, char const* message)
+//	Writes a number with padding.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		value	Number.
+//	@param[in]		width	Minimum width.
+//	@param[in]		fill	Character of padding.
+inline void
+put_number(impl::buffer_t& buffer, std::uint64_t value, std::size_t width, char fill)
 {
-	using namespace std::string_literals;
+	char		digits[24];
+	auto const	result{ std::to_chars(std::begin(digits), std::end(digits), value) };
+	auto const	size{ static_cast<std::size_t>(result.ptr - digits) };
+	for(auto n{ size }; n < width; ++n)
+	{
+		buffer.write(&fill, 1u);
+	}
+	buffer.write(digits, size);
+}
 
-	validate_argument(level != level_t::Silent && level != level_t::All);
-	if(pos)
+namespace impl {
+
+//	Converts time into local time.
+//	@param[in]		tt		Time.
+//	@return		Local time.
+inline std::tm
+local_time(std::time_t tt)
+{
+	std::tm	lt{};
+#if defined(xxx_standard_cpp_only)
+	static std::mutex	mutex_s;
+	std::lock_guard		lock{ mutex_s };
+	lt	= *std::localtime(&tt);
+#elif defined(xxx_win32)
+	::localtime_s(&lt, &tt);
+#elif defined(xxx_posix)
+	::localtime_r(&tt, &lt);
+#endif
+	return lt;
+}
+
+//	Timestamp whose date and time zone are cached per second.
+class timestamp_t
+{
+public:
+	//	Writes the timestamp, e.g., "2020-01-02T03:04:05.123456+0900".
+	//	@param[in,out]	buffer	Buffer.
+	//	@param[in]		time	Time.
+	void
+	write(buffer_t& buffer, std::chrono::system_clock::time_point const& time)
 	{
-		validate_argument(pos->file_name() != nullptr && pos->function_name() != nullptr);
+		auto const	since{ time.time_since_epoch() };
+		auto const	second{ std::chrono::floor<std::chrono::seconds>(since) };
+		if(second != second_ || date_size_ == 0u)
+		{
+			auto const	lt{ local_time(std::chrono::system_clock::to_time_t(std::chrono::system_clock::time_point{ second })) };
+			date_size_	= std::strftime(date_, sizeof(date_), "%FT%T.", &lt);
+			zone_size_	= std::strftime(zone_, sizeof(zone_), "%z", &lt);
+			second_		= second;
+		}
+		buffer.write(date_, date_size_);
+		put_number(buffer, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(since - second).count()), 6u, '0');
+		buffer.write(zone_, zone_size_);
 	}
+private:
+	std::chrono::seconds	second_{};		//< Second of the cache.
+	char					date_[32]{};	//< Date and time.
+	std::size_t				date_size_{};	//< Length of date and time.
+	char					zone_[16]{};	//< Time zone.
+	std::size_t				zone_size_{};	//< Length of time zone.
+};
+
+//	Position of source in a line.
+struct position_t
+{
+	std::string_view		file;		//< File name without directories.
+	std::uint_least32_t		line;		//< Line number.
+	std::string_view		function;	//< Function name.
+};
+
+//	Escape sequence to reset the color of console.
+constexpr char const*	color_reset{ "\x1b[0m" };
 
-	if(static_cast<int>(level_) < static_cast<int>(level))
+//	Gets the escape sequence of the color of console.
+//	@param[in]		level		Logging level.
+//	@return		Escape sequence.
+inline char const*
+color_of(level_t level) noexcept
+{
+	switch(level)
 	{
-		return;
+	case level_t::Fatal:	return "\x1b[37m\x1b[41m";	// Red (reversed)
+	case level_t::Error:	return "\x1b[31m";				// Red
+	case level_t::Warn:		return "\x1b[33m";				// Yellow
+	case level_t::Notice:	return "\x1b[32m";				// Green
+	case level_t::Info:		return "\x1b[37m";				// White
+	case level_t::Debug:	return "\x1b[35m";				// Magenta
+	case level_t::Trace:	return "\x1b[34m";				// Blue
+	case level_t::Verbose:	return "\x1b[36m";				// Cyan
+	default:				return color_reset;
 	}
+}
 
+//	Writes the prefix of a line, i.e., timestamp, level, and position of source.
+//	@param[in,out]	buffer		Buffer.
+//	@param[in,out]	timestamp	Timestamp.
+//	@param[in]		time		Time of logging.
+//	@param[in]		level		Logging level.
+//	@param[in]		pos			Position of source, or nullptr.
+inline void
+put_prefix(buffer_t& buffer, timestamp_t& timestamp, std::chrono::system_clock::time_point const& time, level_t level, position_t const* pos)
+{
 	char const*	Lv[]{ "[S]", "[F]", "[E]", "[W]", "[N]", "[I]", "[D]", "[T]", "[V]", "[A]" };
 
-	auto const			filename{ pos ? strip(pos->file_name()) : ""s };
+	timestamp.write(buffer, time);
+	buffer.write(Lv[static_cast<int>(level)], 3u);
+	if(pos != nullptr)
+	{
+		buffer.write("{", 1u);
+		buffer.write(pos->file.data(), pos->file.size());
+		buffer.write(":", 1u);
+		put_number(buffer, pos->line, 5u, '_');
+		buffer.write("} ", 2u);
+		buffer.write(pos->function.data(), pos->function.size());
+		buffer.write(" ", 1u);
+	}
+}
+
+std::size_t
+find_json_escape_(char const* data, std::size_t size) noexcept
+{
+	std::size_t	offset{};
+#if defined(xxx_json_sse2)
+	auto const	quote{ _mm_set1_epi8('"') };
+	auto const	backslash{ _mm_set1_epi8('\\') };
+	auto const	control{ _mm_set1_epi8(0x1F) };
+	for( ; offset + 16u <= size; offset += 16u)
+	{
+		auto const	chunk{ _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + offset)) };
+		auto const	found{ _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+			_mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk)) };	// i.e., chunk <= 0x1F as unsigned.
+		if(auto const mask{ static_cast<unsigned>(_mm_movemask_epi8(found)) }; mask != 0u)
+		{
+#if defined(_MSC_VER)
+			unsigned long	index;
+			_BitScanForward(&index, mask);
+			return offset + index;
+#else
+			return offset + static_cast<std::size_t>(__builtin_ctz(mask));
+#endif
+		}
+	}
+#endif	// xxx_json_sse2
+	for( ; offset < size; ++offset)
+	{
+		auto const	ch{ static_cast<unsigned char>(data[offset]) };
+		if(ch < 0x20u || ch == '"' || ch == '\\')
+		{
+			return offset;
+		}
+	}
+	return size;
+}
+
+void
+put_json_string_(buffer_t& buffer, std::string_view str)
+{
+	buffer.write("\"", 1u);
+	while( ! str.empty())
+	{
+		auto const	offset{ find_json_escape_(str.data(), str.size()) };
+		buffer.write(str.data(), offset);
+		if(offset == str.size())
+		{
+			break;
+		}
+		switch(auto const ch{ str[offset] }; ch)
+		{
+		case '"':	buffer.write("\\\"", 2u);	break;
+		case '\\':	buffer.write("\\\\", 2u);	break;
+		case '\b':	buffer.write("\\b", 2u);	break;
+		case '\f':	buffer.write("\\f", 2u);	break;
+		case '\n':	buffer.write("\\n", 2u);	break;
+		case '\r':	buffer.write("\\r", 2u);	break;
+		case '\t':	buffer.write("\\t", 2u);	break;
+		default:
+			{
+				char const	hex[]{ "0123456789abcdef" };
+				char const	escaped[]{ '\\', 'u', '0', '0', hex[(ch >> 4) & 0x0F], hex[ch & 0x0F] };
+				buffer.write(escaped, sizeof(escaped));
+			}
+			break;
+		}
+		str.remove_prefix(offset + 1u);
+	}
+	buffer.write("\"", 1u);
+}
+
+//	Writes the head of a JSON line, i.e., timestamp, level, and position of source.
+//	The members of arguments and the closing brace follow it.
+//	@param[in,out]	buffer		Buffer.
+//	@param[in,out]	timestamp	Timestamp.
+//	@param[in]		time		Time of logging.
+//	@param[in]		level		Logging level.
+//	@param[in]		pos			Position of source, or nullptr.
+inline void
+put_json_prefix(buffer_t& buffer, timestamp_t& timestamp, std::chrono::system_clock::time_point const& time, level_t level, position_t const* pos)
+{
+	std::string_view const	Lv[]{ "silent", "fatal", "error", "warn", "notice", "info", "debug", "trace", "verbose", "all" };
 
-	std::ostringstream	oss;
+	buffer.write("{\"time\":\"", 9u);
+	timestamp.write(buffer, time);
+	buffer.write("\",\"level\":\"", 11u);
+	auto const	lv{ Lv[static_cast<int>(level)] };
+	buffer.write(lv.data(), lv.size());
+	buffer.write("\",", 2u);
+	if(pos != nullptr)
+	{
+		buffer.write("\"file\":", 7u);
+		put_json_string_(buffer, pos->file);
+		buffer.write(",\"line\":", 8u);
+		put_number(buffer, pos->line, 1u, '0');
+		buffer.write(",\"function\":", 12u);
+		put_json_string_(buffer, pos->function);
+		buffer.write(",", 1u);
+	}
+}
 
+//	Steady clock calibrated with the system clock periodically.
+//	Timestamps never go backwards, neither between nor across calibrations:
+//	a calibration steps forward to the system clock, but it never steps backward,
+//	so that timestamps run ahead at the steady rate until the system clock catches up after it is set back.
+class calibrated_clock_t
+{
+public:
+	//	Gets the current time.
+	//	@return		Current time.
+	static std::chrono::system_clock::time_point
+	now() noexcept
 	{
 		using namespace std::chrono_literals;
 
-		auto const					now{ std::chrono::system_clock::now() };
-		std::tm						lt;
-		std::chrono::microseconds	ms;
+		auto const	steady{ std::chrono::steady_clock::now().time_since_epoch().count() };
+		for(;;)
 		{
-			std::lock_guard	lock{mutex_};
-			auto const		tt{std::chrono::system_clock::to_time_t(now)};
-			lt	= *std::localtime(&tt);
-			ms	= std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()) % 1s;
+			auto const	sequence{ sequence_s.load(std::memory_order_acquire) };
+			auto const	steady_base{ steady_base_s.load(std::memory_order_relaxed) };
+			auto const	system_base{ system_base_s.load(std::memory_order_relaxed) };
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if((sequence & 1u) != 0u || sequence != sequence_s.load(std::memory_order_relaxed))
+			{
+				continue;	// being calibrated.
+			}
+			auto const	elapsed{ std::chrono::steady_clock::duration{ steady - steady_base } };
+			if(sequence == 0u || period_ <= elapsed)
+			{
+				calibrate_();
+				continue;
+			}
+			return std::chrono::system_clock::time_point{} + std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds{ system_base } + elapsed);
 		}
-
-		oss << std::put_time(&lt, "%FT%T.")
-			<< std::setfill('0') << std::setw(6) << ms.count()
-			<< std::put_time(&lt, "%z")
-			<< Lv[static_cast<int>(level)];
-		if(pos)
+	}
+private:
+	static void
+	calibrate_() noexcept
+	{
+		if(calibrating_s.test_and_set(std::memory_order_acquire))
+		{
+			return;	// another thread is calibrating.
+		}
+		auto const	sequence{ sequence_s.load(std::memory_order_relaxed) };
+		sequence_s.store(sequence + 1u, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		auto const	steady{ std::chrono::steady_clock::now().time_since_epoch().count() };
+		auto		system{ std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count() };
+		if(sequence != 0u)
 		{
-			oss << "{" << filename << ':' << std::setw(5) << std::setfill('_') <<  pos->line() << "} " << pos->function_name() << " ";
+			// The time of the previous calibration at the same moment.
+			auto const	elapsed{ std::chrono::steady_clock::duration{ steady - steady_base_s.load(std::memory_order_relaxed) } };
+			auto const	continued{ system_base_s.load(std::memory_order_relaxed) + std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() };
+			system	= std::max(system, continued);
 		}
-		oss << (message == nullptr ? "" : message);
+		steady_base_s.store(steady, std::memory_order_relaxed);
+		system_base_s.store(system, std::memory_order_relaxed);
+		sequence_s.store(sequence + 2u, std::memory_order_release);
+		calibrating_s.clear(std::memory_order_release);
 	}
-	auto const	str{ oss.str() };
+private:
+	static constexpr std::chrono::seconds		period_{ 10 };	//< Period of calibration.
 
-	if(console_)
+	inline static std::atomic<std::uint64_t>						sequence_s{};		//< Sequence lock.
+	inline static std::atomic<std::chrono::steady_clock::rep>		steady_base_s{};	//< Steady clock at the calibration.
+	inline static std::atomic<std::int64_t>							system_base_s{};	//< System clock at the calibration in nanoseconds.
+	inline static std::atomic_flag									calibrating_s = ATOMIC_FLAG_INIT;	//< Whether it is being calibrated or not.
+};
+
+//	Kind of the message of a record.
+enum class kind_t
+{
+	Text,		//< Formatted message.
+	Binary,		//< Payload of binary record.
+	Json,		//< Members of JSON line.
+	Line,		//< Whole line for a sink.
+};
+
+//	Record of asynchronous logging.
+struct record_t
+{
+	level_t									level{};	//< Logging level.
+	std::optional<sl::source_location>		pos{};		//< Position of source.
+	std::chrono::system_clock::time_point	time{};		//< Time of logging.
+	std::string								message{};	//< Message, payload of binary record, or members of JSON line.
+	kind_t									kind{};		//< Kind of the message.
+	std::size_t								offset{};	//< Offset of the message in the whole line.
+	std::size_t								size{};		//< Size of the message in the whole line.
+	format_t								format{};	//< Format of the whole line.
+};
+
+//	Bounded lock-free queue for multiple producers.
+//	@tparam		T		Type of element.
+template<typename T>
+class ring_t
+{
+public:
+	//	Pushes an element.
+	//	@param[in]		fill	Function object to fill the claimed element.
+	//	@return		If the queue is full, it returns false; otherwise, it returns true.
+	template<typename F>
+	bool
+	push(F const& fill)
 	{
-		ignore_exceptions([this, &str, level]()
+		auto	pos{ head_.load(std::memory_order_relaxed) };
+		for(;;)
 		{
-			std::string		begin;
-			switch(level)
+			auto&		cell{ cells_[pos & mask_] };
+			auto const	seq{ cell.sequence.load(std::memory_order_acquire) };
+			auto const	diff{ static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos) };
+			if(diff == 0)
 			{
-			case level_t::Fatal:	begin	= "\x1b[37m\x1b[41m"s;	break;	// Red (reversed)
-			case level_t::Error:	begin	= "\x1b[31m"s;			break;	// Red
-			case level_t::Warn:		begin	= "\x1b[33m"s;			break;	// Yellow
-			case level_t::Notice:	begin	= "\x1b[32m"s;			break;	// Green
-			case level_t::Info:		begin	= "\x1b[37m"s;			break;	// White
-			case level_t::Debug:	begin	= "\x1b[35m"s;			break;	// Magenta
-			case level_t::Trace:	begin	= "\x1b[34m"s;			break;	// Blue
-			case level_t::Verbose:	begin	= "\x1b[36m"s;			break;	// Cyan
-			default:				begin	= "\x1b[0m"s;			break;
+				if(head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					fill(cell.value);
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
 			}
+			else if(diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				pos	= head_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+	//	Pops an element.
+	//	@param[in]		take	Function object to take the element.
+	//	@return		If the queue is empty, it returns false; otherwise, it returns true.
+	template<typename F>
+	bool
+	pop(F const& take)
+	{
+		auto	pos{ tail_.load(std::memory_order_relaxed) };
+		for(;;)
+		{
+			auto&		cell{ cells_[pos & mask_] };
+			auto const	seq{ cell.sequence.load(std::memory_order_acquire) };
+			auto const	diff{ static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1) };
+			if(diff == 0)
+			{
+				if(tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					take(cell.value);
+					cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if(diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				pos	= tail_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+	//	Checks whether the next element is ready to pop.
+	//	@return		If the next element is ready, it returns true; otherwise, it returns false.
+	bool
+	ready() const noexcept
+	{
+		auto const	pos{ tail_.load(std::memory_order_relaxed) };
+		return cells_[pos & mask_].sequence.load(std::memory_order_acquire) == pos + 1;
+	}
+	//	Checks whether the next element is vacant to push.
+	//	@return		If the next element is vacant, it returns true; otherwise, it returns false.
+	bool
+	vacant() const noexcept
+	{
+		auto const	pos{ head_.load(std::memory_order_relaxed) };
+		return cells_[pos & mask_].sequence.load(std::memory_order_acquire) == pos;
+	}
+	//	Gets the number of claimed elements since construction.
+	//	@return		Number of claimed elements.
+	std::size_t		claimed() const noexcept	{ return head_.load(std::memory_order_acquire);	}
 
-			auto const	end{ "\x1b[0m"s };
+	//	Constructor.
+	//	@param[in]		capacity	Capacity, which is rounded up to power of two.
+	explicit ring_t(std::size_t capacity) : cells_{}, mask_{}, head_{0u}, tail_{0u}
+	{
+		std::size_t	size{ 2u };
+		while(size < capacity)
+		{
+			size	<<= 1;
+		}
+		cells_	= std::make_unique<cell_t[]>(size);
+		mask_	= size - 1;
+		for(std::size_t n{}; n < size; ++n)
+		{
+			cells_[n].sequence.store(n, std::memory_order_relaxed);
+		}
+	}
+private:
+	struct cell_t
+	{
+		std::atomic<std::size_t>	sequence{};	//< Sequence to synchronize producers and consumer.
+		T							value{};	//< Element.
+	};
+	std::unique_ptr<cell_t[]>					cells_;	//< Elements.
+	std::size_t									mask_;	//< Mask of index.
+	alignas(64)	std::atomic<std::size_t>		head_;	//< Position to push.
+	alignas(64)	std::atomic<std::size_t>		tail_;	//< Position to pop.
+};
 
-			std::lock_guard lock{console_mutex_};
+//	Background writer of asynchronous logging.
+class worker_t
+{
+public:
+	using	writer_t	= std::function<void(record_t const&)>;
 
-			std::clog << begin << str << end << std::endl;
+	//	Queues a record.
+	//	@param[in]		level		Logging level.
+	//	@param[in]		pos			Position of source.
+	//	@param[in]		time		Time of logging.
+	//	@param[in]		message		Message.
+	//	@param[in]		kind		Kind of the message.
+	void
+	push(level_t level, std::optional<sl::source_location> const& pos, std::chrono::system_clock::time_point const& time, std::string_view message, kind_t kind)
+	{
+		push_([&](record_t& record)
+		{
+			record.level	= level;
+			record.pos		= pos;
+			record.time		= time;
+			record.message.assign(message);	// reuses the capacity of the cell.
+			record.kind		= kind;
 		});
 	}
-	if( ! path_.empty())
+	//	Queues a whole line for a sink.
+	//	@param[in]		line		Line.
+	void
+	push(line_t const& line)
 	{
-		ignore_exceptions([&str, this]()
+		push_([&line](record_t& record)
 		{
-			std::lock_guard lock{file_mutex_};
+			record.level	= line.level;
+			record.pos		= std::nullopt;
+			record.time		= line.time;
+			record.message.assign(line.text);	// reuses the capacity of the cell.
+			record.kind		= kind_t::Line;
+			record.offset	= static_cast<std::size_t>(line.message.data() - line.text.data());
+			record.size		= line.message.size();
+			record.format	= line.format;
+		});
+	}
+	//	Waits until the queued records are written.
+	void
+	flush()
+	{
+		auto const			target{ ring_.claimed() };
+		std::unique_lock	lock{ mutex_ };
+		cv_.notify_one();
+		done_cv_.wait(lock, [this, target]() { return target <= done_.load(std::memory_order_acquire) || stopped_; });
+	}
 
-			std::ofstream	ofs{path_, std::ios::app};
-			if(ofs.is_open())
+	//	Constructor.
+	//	@param[in]		capacity	Capacity of the queue.
+	//	@param[in]		overflow	Policy when the queue is full.
+	//	@param[in]		writer		Function object to write a record.
+	//	@param[in]		total		Counter of dropped records in total, or nullptr.
+	worker_t(std::size_t capacity, overflow_t overflow, writer_t const& writer, std::atomic<std::uint64_t>* total=nullptr) :
+		ring_{ capacity }, overflow_{ overflow }, writer_{ writer }, total_{ total }, dropped_{ 0u }, done_{ 0u }, blocked_{ 0u },
+		sleeping_{ false }, stopping_{ false }, stopped_{ false }, mutex_{}, cv_{}, done_cv_{}, vacant_cv_{}, thread_{}
+	{
+		thread_	= std::thread{ [this]() { run_(); } };
+	}
+	//	Destructor.
+	//	It writes the queued records before destruction.
+	~worker_t()
+	{
+		{
+			std::lock_guard	lock{ mutex_ };
+			stopping_	= true;
+		}
+		cv_.notify_one();
+		ignore_exceptions([this]() { thread_.join(); });
+	}
+private:
+	//	Queues a record filled by the function object.
+	//	@param[in]		fill		Function object to fill the record.
+	template<typename F>
+	void
+	push_(F const& fill)
+	{
+		while( ! ring_.push(fill))
+		{
+			switch(overflow_)
 			{
-				ofs << str << std::endl;
+			case overflow_t::DropNewest:
+				drop_();
+				return;
+			case overflow_t::DropOldest:
+				if(ring_.pop([](record_t const&){}))
+				{
+					drop_();
+					done_.fetch_add(1u, std::memory_order_release);
+				}
+				break;
+			case overflow_t::Block:	[[fallthrough]];
+			default:
+				wait_vacancy_();
+				break;
 			}
-		});
+		}
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(sleeping_.load(std::memory_order_relaxed))
+		{
+			wake_();
+		}
 	}
-	if( ! logger_.empty())
+	void
+	drop_() noexcept
 	{
-		ignore_exceptions([&str, level, this]()
+		dropped_.fetch_add(1u, std::memory_order_relaxed);
+		if(total_ != nullptr)
 		{
-#if defined(xxx_standard_cpp_only)
+			total_->fetch_add(1u, std::memory_order_relaxed);
+		}
+	}
+	void
+	wake_()
+	{
+		std::lock_guard	lock{ mutex_ };
+		cv_.notify_one();
+	}
+	//	Parks the producer until the writer thread pops a record.
+	void
+	wait_vacancy_()
+	{
+		using namespace std::chrono_literals;
 
-#elif defined(xxx_win32)
-			std::lock_guard lock{mutex_};
+		std::unique_lock	lock{ mutex_ };
+		blocked_.fetch_add(1u, std::memory_order_seq_cst);
+		cv_.notify_one();
+		// The timeout only bounds a missed notification.
+		vacant_cv_.wait_for(lock, 10ms, [this]() { return ring_.vacant() || stopped_; });
+		blocked_.fetch_sub(1u, std::memory_order_relaxed);
+	}
+	void
+	notify_vacancy_()
+	{
+		std::lock_guard	lock{ mutex_ };
+		vacant_cv_.notify_all();
+	}
+	void
+	drain_()
+	{
+		using namespace std::string_literals;
 
-			::OutputDebugStringA(("[" + logger_ + "] " + str + "\r\n").c_str());
-#elif defined(xxx_posix)
-			int		lv;
-			switch (level)
+		if(auto const dropped{ dropped_.exchange(0u, std::memory_order_relaxed) }; 0u < dropped)
+		{
+			record_t const	record{ level_t::Warn, std::nullopt, std::chrono::system_clock::now(), std::to_string(dropped) + " record(s) dropped by overflow"s, kind_t::Text };
+			ignore_exceptions([this, &record]() { writer_(record); });
+		}
+		while(ring_.pop([this](record_t const& record)
+		{
+			ignore_exceptions([this, &record]() { writer_(record); });
+		}))
+		{
+			done_.fetch_add(1u, std::memory_order_release);
+			if(0u < blocked_.load(std::memory_order_relaxed))
 			{
-			case level_t::Fatal:	lv = LOG_CRIT;		break;
-			case level_t::Error:	lv = LOG_ERR;		break;
-			case level_t::Warn:		lv = LOG_WARNING;	break;
-			case level_t::Notice:	lv = LOG_NOTICE;	break;
-			case level_t::Info:		lv = LOG_INFO;		break;
-			case level_t::Debug:	lv = LOG_DEBUG;		break;
-			case level_t::Trace:	lv = LOG_DEBUG;		break;
-			case level_t::Verbose:	lv = LOG_DEBUG;		break;
-			default:				lv = LOG_CRIT;		break;
+				notify_vacancy_();
 			}
+		}
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(0u < blocked_.load(std::memory_order_relaxed))
+		{
+			notify_vacancy_();
+		}
+	}
+	void
+	run_()
+	{
+		using namespace std::chrono_literals;
 
-			std::lock_guard lock{mutex_};
-
-			::openlog(logger_.c_str(), LOG_PID, LOG_USER);
-			::syslog(lv, "%s", str.c_str());
-#else
-			// unsupported platform.
-#endif
-		});
+		for(;;)
+		{
+			drain_();
+			std::unique_lock	lock{ mutex_ };
+			done_cv_.notify_all();
+			if(stopping_)
+			{
+				break;
+			}
+			sleeping_.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			cv_.wait_for(lock, 100ms, [this]() { return stopping_ || ring_.ready() || 0u < dropped_.load(std::memory_order_relaxed); });
+			sleeping_.store(false, std::memory_order_relaxed);
+		}
+		// Producers may have pushed after the last drain.
+		drain_();
+		std::lock_guard	lock{ mutex_ };
+		stopped_	= true;
+		done_cv_.notify_all();
+		vacant_cv_.notify_all();
 	}
-}
+private:
+	ring_t<record_t>				ring_;		//< Queue.
+	overflow_t						overflow_;	//< Policy when the queue is full.
+	writer_t						writer_;	//< Function object to write a record.
+	std::atomic<std::uint64_t>*		total_;		//< Counter of dropped records in total, or nullptr.
+	std::atomic<std::size_t>		dropped_;	//< Number of dropped records to notify.
+	std::atomic<std::size_t>		done_;		//< Number of written or dropped records.
+	std::atomic<std::size_t>		blocked_;	//< Number of producers waiting for vacancy.
+	std::atomic<bool>				sleeping_;	//< Whether the writer thread is sleeping or not.
+	bool							stopping_;	//< Whether the writer thread is stopping or not.
+	bool							stopped_;	//< Whether the writer thread stopped or not.
+	std::mutex						mutex_;		//< Mutex.
+	std::condition_variable			cv_;		//< Condition to wake the writer thread.
+	std::condition_variable			done_cv_;	//< Condition to notify written records.
+	std::condition_variable			vacant_cv_;	//< Condition to wake producers blocked by a full queue.
+	std::thread						thread_;	//< Writer thread.
+};
+
+//	Formatted lines gathered by a thread.
+struct batch_t
+{
+	//	Line in the batch.
+	struct entry_t
+	{
+		level_t									level;		//< Logging level.
+		std::chrono::system_clock::time_point	time;		//< Time of logging.
+		std::size_t								offset;		//< Offset of the line in the text.
+		std::size_t								size;		//< Size of the line.
+		std::size_t								message;	//< Offset of the message in the line.
+		std::size_t								length;		//< Size of the message.
+		format_t								format;		//< Format of the line.
+	};
 
-std::once_flag												logger_once_s;
-std::mutex													loggers_mutex_s;
-std::unordered_map<std::string, std::unique_ptr<logger_t>>	loggers_s;
+	std::mutex								mutex{};	//< Mutex against the flusher thread.
+	std::string								text{};		//< Lines.
+	std::vector<entry_t>					entries{};	//< Lines in the text.
+	std::chrono::steady_clock::time_point	since{};	//< Time of the first line.
+	std::atomic<bool>						closed{};	//< Whether the owner is destroyed or not.
 
-void
-add_logger(std::string const& tag, level_t level, std::filesystem::path const& path, std::string const& logger, bool console)
+	//	Appends a line.
+	//	@param[in]		line		Line.
+	void
+	append(line_t const& line)
+	{
+		entries.push_back(entry_t{ line.level, line.time, text.size(), line.text.size(),
+			static_cast<std::size_t>(line.message.data() - line.text.data()), line.message.size(), line.format });
+		text.append(line.text);
+	}
+	//	Gets the lines.
+	//	@param[out]		lines		Lines, which refer the text.
+	void
+	lines(std::vector<line_t>& lines) const
+	{
+		lines.clear();
+		for(auto const& entry : entries)
+		{
+			auto const	str{ std::string_view{ text }.substr(entry.offset, entry.size) };
+			lines.push_back(line_t{ entry.level, entry.time, str.substr(entry.message, entry.length), str, entry.format });
+		}
+	}
+	//	Checks whether the batch is empty or not.
+	//	@return		If the batch is empty, it returns true; otherwise, it returns false.
+	bool	empty() const noexcept	{ return entries.empty();	}
+	//	Gets the size of the batch.
+	//	@return		Size in bytes.
+	std::size_t		size() const noexcept	{ return text.size();	}
+};
+
+//	Buffers of batched writes per thread.
+class batcher_t
 {
-	validate_argument( ! tag.empty());
+public:
+	using	writer_t	= std::function<void(batch_t const&)>;
 
-	std::lock_guard		lock{ loggers_mutex_s };
+	//	Appends a line into the buffer of the current thread.
+	//	@param[in]		line		Line.
+	void
+	append(line_t const& line)
+	{
+		auto&			batch{ local_() };
+		std::lock_guard	lock{ batch.mutex };
+		if(batch.empty())
+		{
+			batch.since	= std::chrono::steady_clock::now();
+		}
+		batch.append(line);
+		if(size_ <= batch.size() || line.level == level_t::Fatal || line.level == level_t::Error)
+		{
+			commit_(batch);
+		}
+	}
+	//	Writes the buffers of all the threads.
+	void
+	flush()
+	{
+		std::lock_guard	lock{ mutex_ };
+		for(auto const& batch : batches_)
+		{
+			std::lock_guard	batch_lock{ batch->mutex };
+			commit_(*batch);
+		}
+	}
 
-	auto	itr{ loggers_s.find(tag) };
-	validate_argument(itr == std::end(loggers_s));
+	//	Constructor.
+	//	@param[in]		size		Size of buffer per thread.
+	//	@param[in]		latency		Maximum latency before a partial buffer is written.
+	//	@param[in]		writer		Function object to write a batch.
+	batcher_t(std::size_t size, std::chrono::milliseconds latency, writer_t const& writer) :
+		id_{ ++sequence_s }, size_{ size }, latency_{ latency }, writer_{ writer }, batches_{}, stopping_{ false }, mutex_{}, cv_{}, thread_{}
+	{
+		thread_	= std::thread{ [this]() { run_(); } };
+	}
+	//	Destructor.
+	//	It writes the buffers before destruction.
+	~batcher_t()
+	{
+		{
+			std::lock_guard	lock{ mutex_ };
+			stopping_	= true;
+		}
+		cv_.notify_one();
+		ignore_exceptions([this]() { thread_.join(); });
+		ignore_exceptions([this]() { flush(); });
+		for(auto const& batch : batches_)
+		{
+			batch->closed.store(true, std::memory_order_release);
+		}
+	}
+private:
+	batch_t&
+	local_()
+	{
+		thread_local std::unordered_map<std::uint64_t, std::shared_ptr<batch_t>>	batches_s;
 
-	loggers_s[tag]	= std::make_unique<logger_t>(level, path, logger, console);
-}
+		auto&	batch{ batches_s[id_] };
+		if( ! batch)
+		{
+			// Forgets the batches of destroyed loggers.
+			for(auto itr{ std::begin(batches_s) }; itr != std::end(batches_s); )
+			{
+				itr	= itr->second && itr->second->closed.load(std::memory_order_acquire) ? batches_s.erase(itr) : std::next(itr);
+			}
+			auto	created{ std::make_shared<batch_t>() };
+			{
+				std::lock_guard	lock{ mutex_ };
+				batches_.push_back(created);
+			}
+			batches_s[id_]	= std::move(created);
+			return *batches_s[id_];
+		}
+		return *batch;
+	}
+	void
+	commit_(batch_t& batch)
+	{
+		if( ! batch.empty())
+		{
+			ignore_exceptions([this, &batch]() { writer_(batch); });
+		}
+		batch.text.clear();	// keeps the capacity.
+		batch.entries.clear();
+	}
+	void
+	run_()
+	{
+		using namespace std::chrono_literals;
 
-void
-remove_logger(std::string const& tag)
+		auto const			interval{ std::max<std::chrono::milliseconds>(latency_ / 2, 1ms) };
+		std::unique_lock	lock{ mutex_ };
+		while( ! stopping_)
+		{
+			cv_.wait_for(lock, interval);
+			auto const	now{ std::chrono::steady_clock::now() };
+			for(auto itr{ std::begin(batches_) }; itr != std::end(batches_); )
+			{
+				auto&	batch{ **itr };
+				{
+					std::lock_guard	batch_lock{ batch.mutex };
+					if( ! batch.empty() && latency_ <= now - batch.since)
+					{
+						commit_(batch);
+					}
+				}
+				// The owner thread exited.
+				itr	= itr->use_count() == 1 && batch.empty() ? batches_.erase(itr) : std::next(itr);
+			}
+		}
+	}
+private:
+	inline static std::atomic<std::uint64_t>	sequence_s{};	//< Sequence of identifiers.
+
+	std::uint64_t							id_;		//< Identifier, which is never reused.
+	std::size_t								size_;		//< Size of buffer per thread.
+	std::chrono::milliseconds				latency_;	//< Maximum latency.
+	writer_t								writer_;	//< Function object to write a batch.
+	std::vector<std::shared_ptr<batch_t>>	batches_;	//< Buffers of all the threads.
+	bool									stopping_;	//< Whether the flusher thread is stopping or not.
+	std::mutex								mutex_;		//< Mutex.
+	std::condition_variable					cv_;		//< Condition to stop the flusher thread.
+	std::thread								thread_;	//< Flusher thread.
+};
+
+//	Magic number and version at the head of binary log files.
+constexpr std::string_view	magic_s{ "xxxlog\x01", 7u };
+
+//	Source location of binary records.
+struct site_t
 {
-	validate_argument( ! tag.empty());
+	std::string				file{};		//< File name without directories.
+	std::uint_least32_t		line{};		//< Line number.
+	std::string				function{};	//< Function name.
+};
+
+//	Identifiers of source locations of binary records.
+class sites_t
+{
+public:
+	//	Gets the identifier of a source location.
+	//	The identifier is cached per thread by the addresses of the names.
+	//	@param[in]		pos		Position of source.
+	//	@return		Identifier, which starts from one.
+	std::uint64_t
+	id(sl::source_location const& pos)
+	{
+		thread_local std::unordered_map<key_t, std::uint64_t, hash_t>	cache_s;
 
-	std::lock_guard		lock{ loggers_mutex_s };
+		key_t const	key{ pos.file_name(), pos.function_name(), pos.line() };
+		if(auto const itr{ cache_s.find(key) }; itr != std::end(cache_s))
+		{
+			return itr->second;
+		}
 
-	auto	itr{ loggers_s.find(tag) };
-	validate_argument(itr != std::end(loggers_s));
-	loggers_s.erase(itr);
-}
+		std::lock_guard	lock{ mutex_ };
+		site_t	site{ std::string(strip(pos.file_name())), pos.line(), pos.function_name() };
+		auto const	[itr, inserted]{ ids_.try_emplace(std::tuple{ site.file, site.line, site.function }, sites_.size() + 1u) };
+		if(inserted)
+		{
+			sites_.push_back(std::move(site));
+		}
+		cache_s.emplace(key, itr->second);
+		return itr->second;
+	}
+	//	Gets a source location.
+	//	@param[in]		id		Identifier.
+	//	@return		Source location.
+	site_t const&
+	at(std::uint64_t id)
+	{
+		std::lock_guard	lock{ mutex_ };
+		return sites_.at(id - 1u);	// elements of deque are never moved.
+	}
+private:
+	using	key_t	= std::tuple<char const*, char const*, std::uint_least32_t>;
+	struct hash_t
+	{
+		std::size_t
+		operator()(key_t const& key) const noexcept
+		{
+			auto const	h1{ std::hash<char const*>{}(std::get<0>(key)) };
+			auto const	h2{ std::hash<char const*>{}(std::get<1>(key)) };
+			return (h1 * 31u + h2) * 31u + std::get<2>(key);
+		}
+	};
+private:
+	std::map<std::tuple<std::string, std::uint_least32_t, std::string>, std::uint64_t>	ids_;	//< Identifiers.
+	std::deque<site_t>		sites_;		//< Source locations.
+	std::mutex				mutex_;		//< Mutex.
+};
+
+sites_t		sites_s;
 
-logger_t& logger(std::string const& tag)
+class file_t;
+
+//	Flusher of buffered log files at intervals.
+class flusher_t
 {
-	std::call_once(logger_once_s, []()
+public:
+	//	Adds a file to flush.
+	//	@param[in]		file		File.
+	//	@param[in]		interval	Interval to flush.
+	void
+	add(file_t* file, std::chrono::milliseconds interval)
+	{
+		using namespace std::chrono_literals;
+
+		std::lock_guard	lock{ mutex_ };
+		files_.insert(file);
+		interval_	= std::min(interval_, std::max(interval, 10ms));
+		if( ! thread_.joinable())
 		{
-			std::lock_guard		lock{ loggers_mutex_s };
-			loggers_s[""]	= std::make_unique<logger_t>();
-		});
+			thread_	= std::thread{ [this]() { run_(); } };
+		}
+	}
+	//	Removes a file.
+	//	@param[in]		file		File.
+	void
+	remove(file_t* file)
+	{
+		std::lock_guard	lock{ mutex_ };
+		files_.erase(file);
+	}
+
+	flusher_t() : files_{}, interval_{ 1000 }, stopping_{ false }, mutex_{}, cv_{}, thread_{}
+	{}
+	~flusher_t()
+	{
+		{
+			std::lock_guard	lock{ mutex_ };
+			stopping_	= true;
+		}
+		cv_.notify_one();
+		if(thread_.joinable())
+		{
+			ignore_exceptions([this]() { thread_.join(); });
+		}
+	}
+private:
+	void	run_();
+private:
+	std::unordered_set<file_t*>	files_;		//< Files to flush.
+	std::chrono::milliseconds	interval_;	//< Interval to check the files.
+	bool						stopping_;	//< Whether the thread is stopping or not.
+	std::mutex					mutex_;		//< Mutex.
+	std::condition_variable		cv_;		//< Condition to stop the thread.
+	std::thread					thread_;	//< Flusher thread.
+};
 
-	std::lock_guard		lock{ loggers_mutex_s };
+//	It is defined before the loggers so that it outlives them.
+flusher_t	flusher_s;
 
-	auto itr{ loggers_s.find(tag) };
-	validate_argument(itr != std::end(loggers_s));
-	return *itr->second;
-}
+//	Log file kept open with a write buffer.
+class file_t
+{
+public:
+	using	clock_t	= std::chrono::system_clock;
 
-#endif	// xxx_no_logging
+	//	Writes a line.
+	//	Lines are buffered, so that a failure may be reported by a later write.
+	//	@param[in]		level		Logging level.
+	//	@param[in]		time		Time of logging.
+	//	@param[in]		line		Line without newline.
+	//	@exception		std::system_error	The file cannot be opened or written.
+	void
+	write(level_t level, clock_t::time_point const& time, std::string_view line)
+	{
+		std::lock_guard	lock{ mutex_ };
 
-}	// namespace log
-}	// namespace xxx
+		prepare_(time, line.size() + 1u);
+
+		append_(line.data(), line.size());
+		append_("\n", 1u);
+		flush_by_(level, time);
+	}
+	//	Writes lines at once bypassing the buffer.
+	//	@param[in]		time		Time of the last line.
+	//	@param[in]		lines		Lines terminated by newline.
+	//	@exception		std::system_error	The file cannot be opened or written.
+	void
+	write_lines(clock_t::time_point const& time, std::string_view lines)
+	{
+		std::lock_guard	lock{ mutex_ };
+
+		prepare_(time, lines.size());
 
+		flush_();
+		size_	+= lines.size();
+		put_(lines.data(), lines.size());
+	}
+	//	Writes a binary record.
+	//	The source location is defined in the file before its first record.
+	//	@param[in]		level		Logging level.
+	//	@param[in]		time		Time of logging.
+	//	@param[in]		site		Identifier of source location, or zero.
+	//	@param[in]		payload		Encoded arguments.
+	//	@exception		std::system_error	The file cannot be opened or written.
+	void
+	write_binary(level_t level, clock_t::time_point const& time, std::uint64_t site, std::string_view payload)
+	{
+		std::lock_guard	lock{ mutex_ };
+
+		prepare_(time, payload.size() + 32u);
+
+		frame_.clear();
+		if(size_ == 0u)
+		{
+			frame_.write(magic_s.data(), magic_s.size());
+		}
+		if(0u < site && (defined_.size() <= site || ! defined_[site]))
+		{
+			auto const&	s{ sites_s.at(site) };
+			put_tag_(frame_, tag::Site);
+			put_varint_(frame_, site);
+			put_varint_(frame_, s.line);
+			put_string_(frame_, s.file);
+			put_string_(frame_, s.function);
+			defined_.resize(std::max<std::size_t>(defined_.size(), site + 1u));
+			defined_[site]	= true;
+		}
+		put_tag_(frame_, tag::Record);
+		put_varint_(frame_, site);
+		put_fixed_(frame_, static_cast<std::uint64_t>(level), 1u);
+		put_fixed_(frame_, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count()), 8u);
+		put_fixed_(frame_, payload.size(), 4u);
+
+		auto const	frame{ frame_.view() };
+		append_(frame.data(), frame.size());
+		append_(payload.data(), payload.size());
+		flush_by_(level, time);
+	}
+	//	Flushes the buffer.
+	//	@exception		std::system_error	The file cannot be written.
+	void
+	flush()
+	{
+		std::lock_guard	lock{ mutex_ };
+		flush_();
+	}
+	//	Flushes the buffer if the interval passed.
+	//	@param[in]		now			Current time.
+	void
+	flush_if_expired(clock_t::time_point const& now)
+	{
+		std::lock_guard	lock{ mutex_ };
+		if( ! buffer_.empty() && option_.flush_interval <= now - flushed_)
+		{
+			flush_();
+		}
+	}
+
+	//	Constructor.
+	//	It opens the file.
+	//	@param[in]		path		The path of log file.
+	//	@param[in]		option		Options of log file.
+	file_t(std::filesystem::path const& path, file_option_t const& option) :
+		path_{ path }, option_{ option }, file_{ nullptr, &std::fclose }, buffer_{}, size_{}, period_{}, flushed_{}, opened_{}, error_{}, defined_{}, frame_{}, mutex_{}
+	{
+		buffer_.reserve(option_.buffer_size);
+		open_(clock_t::now());
+		if(0u < option_.buffer_size && 0 < option_.flush_interval.count())
+		{
+			flusher_s.add(this, option_.flush_interval);
+		}
+	}
+	//	Destructor.
+	//	It flushes the buffer and closes the file.
+	~file_t()
+	{
+		flusher_s.remove(this);
+		ignore_exceptions([this]() { flush(); });
+	}
+private:
+	void
+	open_(clock_t::time_point const& now)
+	{
+		using namespace std::chrono_literals;
+
+		if(now - opened_ < 1s)
+		{
+			return;	// avoids to retry opening too often.
+		}
+		opened_	= now;
+		file_.reset(std::fopen(path_.string().c_str(), "ab"));
+		if( ! file_)
+		{
+			error_	= std::error_code{ errno, std::generic_category() };
+			return;
+		}
+		std::setvbuf(file_.get(), nullptr, _IONBF, 0u);	// uses own buffer only.
+
+		std::error_code	ec;
+		auto const		size{ std::filesystem::file_size(path_, ec) };
+		size_		= ec ? 0u : size;
+		period_		= period_of_(now);
+		flushed_	= now;
+		defined_.clear();	// source locations are defined again in each file.
+	}
+	//	Rotates or opens the file if needed.
+	//	@exception		std::system_error	The file is not open, e.g., the last trial to open it failed.
+	void
+	prepare_(clock_t::time_point const& time, std::size_t size)
+	{
+		if(needs_rotation_(time, size))
+		{
+			rotate_(time);
+		}
+		else if( ! file_)
+		{
+			open_(time);
+		}
+		if( ! file_)
+		{
+			throw std::system_error(error_ ? error_ : std::make_error_code(std::errc::io_error), path_.string());
+		}
+	}
+	//	Writes data into the file bypassing the buffer.
+	//	@exception		std::system_error	The data cannot be written.
+	void
+	put_(char const* data, std::size_t size)
+	{
+		if(std::fwrite(data, 1u, size, file_.get()) != size)
+		{
+			auto const	error{ errno };
+			std::clearerr(file_.get());
+			throw std::system_error(error == 0 ? EIO : error, std::generic_category(), path_.string());
+		}
+	}
+	void
+	flush_by_(level_t level, clock_t::time_point const& time)
+	{
+		if(level == level_t::Fatal || level == level_t::Error)
+		{
+			flush_();
+		}
+		else if(0 < option_.flush_interval.count() && option_.flush_interval <= time - flushed_)
+		{
+			flush_();
+		}
+	}
+	void
+	append_(char const* data, std::size_t size)
+	{
+		size_	+= size;
+		if(option_.buffer_size < buffer_.size() + size)
+		{
+			flush_();
+			if(option_.buffer_size < size)
+			{
+				put_(data, size);
+				return;
+			}
+		}
+		buffer_.insert(std::end(buffer_), data, data + size);
+	}
+	void
+	flush_()
+	{
+		flushed_	= clock_t::now();
+		if( ! file_ || buffer_.empty())
+		{
+			buffer_.clear();
+			return;
+		}
+		try
+		{
+			put_(buffer_.data(), buffer_.size());
+		}
+		catch(...)
+		{
+			buffer_.clear();	// the failed lines are dropped.
+			throw;
+		}
+		buffer_.clear();
+	}
+	std::int64_t
+	period_of_(clock_t::time_point const& time) const noexcept
+	{
+		if(option_.rotation_period.count() <= 0)
+		{
+			return 0;
+		}
+		return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count() / option_.rotation_period.count();
+	}
+	bool
+	needs_rotation_(clock_t::time_point const& time, std::size_t size) const noexcept
+	{
+		if( ! file_)
+		{
+			return false;
+		}
+		if(0u < option_.rotation_size && 0u < size_ && option_.rotation_size < size_ + size)
+		{
+			return true;
+		}
+		return period_ < period_of_(time);	// records out of order do not rotate it again.
+	}
+	std::filesystem::path
+	rotated_path_(std::size_t n) const
+	{
+		auto	path{ path_ };
+		path	+= "." + std::to_string(n);
+		return path;
+	}
+	void
+	rotate_(clock_t::time_point const& now)
+	{
+		flush_();
+		file_.reset();
+
+		std::error_code	ec;
+		if(option_.retention == 0u)
+		{
+			std::filesystem::remove(path_, ec);
+		}
+		else
+		{
+			std::filesystem::remove(rotated_path_(option_.retention), ec);
+			for(auto n{ option_.retention - 1u }; 0u < n; --n)
+			{
+				std::filesystem::rename(rotated_path_(n), rotated_path_(n + 1u), ec);
+			}
+			std::filesystem::rename(path_, rotated_path_(1u), ec);
+		}
+		opened_	= {};
+		open_(now);
+	}
+private:
+	std::filesystem::path							path_;		//< The path of log file.
+	file_option_t									option_;	//< Options.
+	std::unique_ptr<std::FILE, decltype(&std::fclose)>	file_;	//< File.
+	std::vector<char>								buffer_;	//< Write buffer.
+	std::uintmax_t									size_;		//< Size of the file including the buffer.
+	std::int64_t									period_;	//< Rotation period of the file.
+	clock_t::time_point								flushed_;	//< Time of the last flush.
+	clock_t::time_point								opened_;	//< Time of the last trial to open.
+	std::error_code									error_;		//< Error of the last trial to open.
+	std::vector<bool>								defined_;	//< Whether source locations are defined in the file or not.
+	buffer_t										frame_;		//< Frame of binary record.
+	std::mutex										mutex_;		//< Mutex.
+};
+
+//	Encodes a message as a binary payload.
+//	@param[in]		message		Message.
+//	@param[in]		consume		Function object to consume the payload.
+template<typename C>
+inline void
+encode_message(std::string_view message, C const& consume)
+{
+	format_([message](std::ostream& os) { encode_(static_cast<buffer_t&>(*os.rdbuf()), message); }, consume);
+}
+
+//	Encodes a message as members of a JSON line.
+//	@param[in]		message		Message.
+//	@param[in]		consume		Function object to consume the members.
+template<typename C>
+inline void
+encode_json_message(std::string_view message, C const& consume)
+{
+	format_([message](std::ostream& os) { json_args_(static_cast<buffer_t&>(*os.rdbuf()), message); }, consume);
+}
+
+//	Sink of standard error.
+class console_sink_t : public sink_t
+{
+public:
+	void
+	write(line_t const& line) override
+	{
+		auto const		colored{ line.format == format_t::Text };	// JSON lines are kept parsable.
+		std::lock_guard	lock{ mutex_ };
+		std::clog << (colored ? color_of(line.level) : "") << line.text << (colored ? color_reset : "") << std::endl;
+		check_();
+	}
+	void
+	write_lines(std::vector<line_t> const& lines) override
+	{
+		thread_local std::string	block_s;
+		block_s.clear();	// keeps the capacity.
+		for(auto const& line : lines)
+		{
+			auto const	colored{ line.format == format_t::Text };
+			block_s.append(colored ? color_of(line.level) : "").append(line.text).append(colored ? color_reset : "").push_back('\n');
+		}
+		std::lock_guard	lock{ mutex_ };
+		std::clog.write(block_s.data(), static_cast<std::streamsize>(block_s.size()));
+		std::clog.flush();
+		check_();
+	}
+
+	char const*	name() const noexcept override	{ return "console";	}
+
+	console_sink_t() : sink_t{}, mutex_{} {}
+private:
+	//	Checks the state of standard error, and clears it so that later lines can be written.
+	//	@exception		std::system_error	Standard error cannot be written.
+	static void
+	check_()
+	{
+		if( ! std::clog)
+		{
+			std::clog.clear();
+			throw std::system_error(std::make_error_code(std::errc::io_error), "standard error");
+		}
+	}
+private:
+	std::mutex		mutex_;		//< Mutex.
+};
+
+//	Sink of log file.
+class file_sink_t : public sink_t
+{
+public:
+	//	Opens a log file.
+	//	The new file is opened before the current one is closed.
+	//	@param[in]		path		The path of log file; empty means no file.
+	//	@param[in]		option		Options of log file.
+	void
+	open(std::filesystem::path const& path, file_option_t const& option)
+	{
+		auto	file{ path.empty() ? nullptr : std::make_unique<file_t>(path, option) };
+		{
+			std::lock_guard	lock{ mutex_ };
+			std::swap(file_, file);
+			open_.store(file_ != nullptr, std::memory_order_relaxed);
+		}
+		// The previous file is flushed and closed here.
+	}
+	//	Checks whether a log file is open or not.
+	//	@return		If a log file is open, it returns true; otherwise, it returns false.
+	bool	is_open() const noexcept	{ return open_.load(std::memory_order_relaxed);	}
+	//	Writes a binary record.
+	//	@param[in]		level		Logging level.
+	//	@param[in]		time		Time of logging.
+	//	@param[in]		site		Identifier of source location, or zero.
+	//	@param[in]		payload		Encoded arguments.
+	//	@exception		std::system_error	No log file is open, or it cannot be written.
+	void
+	write_binary(level_t level, std::chrono::system_clock::time_point const& time, std::uint64_t site, std::string_view payload)
+	{
+		std::lock_guard	lock{ mutex_ };
+		file_of_().write_binary(level, time, site, payload);
+	}
+	void
+	write(line_t const& line) override
+	{
+		std::lock_guard	lock{ mutex_ };
+		file_of_().write(line.level, line.time, line.text);
+	}
+	void
+	write_lines(std::vector<line_t> const& lines) override
+	{
+		thread_local std::string	block_s;
+		block_s.clear();	// keeps the capacity.
+		for(auto const& line : lines)
+		{
+			block_s.append(line.text).push_back('\n');
+		}
+		std::lock_guard	lock{ mutex_ };
+		file_of_().write_lines(lines.back().time, block_s);
+	}
+	void
+	flush() override
+	{
+		std::lock_guard	lock{ mutex_ };
+		if(file_)
+		{
+			file_->flush();
+		}
+	}
+
+	char const*	name() const noexcept override	{ return "file";	}
+
+	file_sink_t() : sink_t{}, file_{}, open_{}, mutex_{} {}
+private:
+	//	Gets the log file; it has been closed if another thread opens no file while lines are written.
+	//	@return		Log file.
+	//	@exception		std::system_error	No log file is open.
+	file_t&
+	file_of_()
+	{
+		if( ! file_)
+		{
+			throw std::system_error(std::make_error_code(std::errc::bad_file_descriptor), "no log file");
+		}
+		return *file_;
+	}
+private:
+	std::unique_ptr<file_t>		file_;		//< Log file.
+	std::atomic<bool>			open_;		//< Whether a log file is open or not.
+	std::mutex					mutex_;		//< Mutex.
+};
+
+#if defined(xxx_syslog_socket)
+
+//	Connection to the local socket of syslog daemon.
+//	It is a replacement of openlog(3) and syslog(3), which share a process-wide identity.
+class syslog_t
+{
+public:
+	//	Sends datagrams in order.
+	//	If the daemon has gone, e.g., it restarted, it connects again once.
+	//	If it cannot connect, it does not try again until the retry interval passes.
+	//	Datagrams which cannot be sent are dropped.
+	//	@param[in]		datagrams	Datagrams.
+	//	@return		If all the datagrams are sent, it returns true; otherwise, it returns false.
+	bool
+	send(std::vector<std::string_view> const& datagrams)
+	{
+		bool	retried{};
+		bool	sent_all{ true };
+		for(std::size_t i{}; i < datagrams.size(); )
+		{
+			if(socket_ < 0 && ! connect_())
+			{
+				return false;	// the daemon is not available.
+			}
+			auto const	sent{ send_(datagrams.data() + i, datagrams.size() - i) };
+			if(0u < sent)
+			{
+				i	+= sent;
+				continue;
+			}
+			auto const	error{ errno };
+			if(error == EINTR)
+			{
+				continue;
+			}
+			if( ! is_disconnected(error))
+			{
+				++i;		// e.g., too long datagram.
+				sent_all	= false;
+				continue;
+			}
+			close_();
+			if(retried)
+			{
+				return false;
+			}
+			retried	= true;
+		}
+		return sent_all;
+	}
+
+	//	Constructor.
+	//	@param[in]		path		Path of the local socket of syslog daemon.
+	explicit syslog_t(std::filesystem::path const& path) : path_{ path }, socket_{ -1 }, retry_{} {}
+	//	Destructor.
+	~syslog_t()	{ close_();	}
+private:
+	syslog_t(syslog_t const&)						= delete;
+	syslog_t const&	operator =(syslog_t const&)		= delete;
+private:
+	static bool
+	is_disconnected(int error) noexcept
+	{
+		return error == ECONNREFUSED || error == ECONNRESET || error == ENOTCONN || error == EPIPE || error == ENOENT || error == EBADF || error == EDESTADDRREQ;
+	}
+	//	Connects to the daemon unless it has failed within the retry interval.
+	//	@return		It returns true if connected; otherwise, false.
+	bool
+	connect_()
+	{
+		constexpr std::chrono::seconds	interval{ 1 };
+		auto const	now{ std::chrono::steady_clock::now() };
+		if(now < retry_)
+		{
+			return false;	// backs off without any system call.
+		}
+		if( ! try_connect_())
+		{
+			retry_	= now + interval;
+			return false;
+		}
+		return true;
+	}
+	bool
+	try_connect_()
+	{
+		::sockaddr_un	address{};
+		auto const&		path{ path_.native() };
+		if(sizeof(address.sun_path) <= path.size())
+		{
+			return false;
+		}
+		address.sun_family	= AF_UNIX;
+		std::memcpy(address.sun_path, path.c_str(), path.size());
+
+		socket_	= ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+		if(socket_ < 0)
+		{
+			return false;
+		}
+		if(::connect(socket_, reinterpret_cast<::sockaddr const*>(&address), sizeof(address)) != 0)
+		{
+			close_();
+			return false;
+		}
+		return true;
+	}
+	void
+	close_() noexcept
+	{
+		if(0 <= socket_)
+		{
+			::close(socket_);
+			socket_	= -1;
+		}
+	}
+	//	Sends datagrams as many as possible by a system call.
+	//	@return		Number of sent datagrams; zero means an error.
+	std::size_t
+	send_(std::string_view const* datagrams, std::size_t size) noexcept
+	{
+#if defined(__linux__)
+		constexpr std::size_t	capacity{ 64u };
+		::mmsghdr	messages[capacity]{};
+		::iovec		vectors[capacity]{};
+		size	= std::min(size, capacity);
+		for(std::size_t i{}; i < size; ++i)
+		{
+			vectors[i].iov_base					= const_cast<char*>(datagrams[i].data());
+			vectors[i].iov_len					= datagrams[i].size();
+			messages[i].msg_hdr.msg_iov			= &vectors[i];
+			messages[i].msg_hdr.msg_iovlen		= 1u;
+		}
+		auto const	sent{ ::sendmmsg(socket_, messages, static_cast<unsigned>(size), MSG_NOSIGNAL) };
+		return sent < 0 ? 0u : static_cast<std::size_t>(sent);
+#else
+		return ::send(socket_, datagrams->data(), datagrams->size(), 0) < 0 ? 0u : 1u;
+#endif
+	}
+private:
+	std::filesystem::path					path_;		//< Path of the local socket.
+	int										socket_;	//< Socket, or negative if it is not connected.
+	std::chrono::steady_clock::time_point	retry_;		//< Time when it can try to connect again after a failure.
+};
+
+#endif
+
+//	Sink of the external logger, i.e., syslog or debugger.
+class external_sink_t : public sink_t
+{
+public:
+	//	Sets the external logger name.
+	//	@param[in]		name		External logger name.
+	void
+	set_name(std::string const& name)
+	{
+		std::lock_guard	lock{ mutex_ };
+		name_	= name;
+#if defined(xxx_syslog_socket)
+		pid_	= 0;	// the prefix is built again by the next write.
+#endif
+	}
+	//	Sets options of syslog.
+	//	The current connection is closed, and the new one is opened on demand.
+	//	@param[in]		option		Options of syslog.
+	void
+	set_option(syslog_option_t const& option)
+	{
+		std::lock_guard	lock{ mutex_ };
+		option_	= option;
+#if defined(xxx_syslog_socket)
+		syslog_.reset();
+#endif
+	}
+	void
+	write(line_t const& line) override
+	{
+		write_(&line, &line + 1);
+	}
+	void
+	write_lines(std::vector<line_t> const& lines) override
+	{
+		write_(lines.data(), lines.data() + lines.size());
+	}
+
+	char const*	name() const noexcept override	{ return "external";	}
+
+	external_sink_t() : sink_t{}, name_{},
+#if defined(xxx_syslog_socket)
+		ident_{}, pid_{},
+#endif
+		option_{},
+#if defined(xxx_syslog_socket)
+		syslog_{},
+#endif
+		mutex_{}
+	{}
+private:
+	void
+	write_([[maybe_unused]] line_t const* first, [[maybe_unused]] line_t const* last)
+	{
+		std::lock_guard	lock{ mutex_ };
+		if(name_.empty())
+		{
+			return;
+		}
+#if defined(xxx_standard_cpp_only)
+
+#elif defined(xxx_win32)
+		for(auto line{ first }; line != last; ++line)
+		{
+			::OutputDebugStringA(("[" + name_ + "] " + std::string(line->text) + "\r\n").c_str());
+		}
+#elif defined(xxx_posix)
+		// It formats messages as RFC 3164 like syslog(3): '<PRI>Mmm dd hh:mm:ss ident[pid]: message'.
+		thread_local std::string					block_s;
+		thread_local std::vector<std::size_t>		ends_s;
+		thread_local std::vector<std::string_view>	datagrams_s;
+		block_s.clear();	// keeps the capacity.
+		ends_s.clear();
+		datagrams_s.clear();
+
+		// The process ID is checked per batch because a child process after fork() has its own one.
+		if(auto const pid{ ::getpid() }; pid != pid_)
+		{
+			pid_	= pid;
+			ident_	= name_ + "[" + std::to_string(pid) + "]: ";
+		}
+
+		for(auto line{ first }; line != last; ++line)
+		{
+			int		severity;
+			switch (line->level)
+			{
+			case level_t::Fatal:	severity = 2;	break;		// critical
+			case level_t::Error:	severity = 3;	break;		// error
+			case level_t::Warn:		severity = 4;	break;		// warning
+			case level_t::Notice:	severity = 5;	break;		// notice
+			case level_t::Info:		severity = 6;	break;		// informational
+			case level_t::Debug:	severity = 7;	break;		// debug
+			case level_t::Trace:	severity = 7;	break;
+			case level_t::Verbose:	severity = 7;	break;
+			default:				severity = 2;	break;
+			}
+			auto const	t{ std::chrono::system_clock::to_time_t(line->time) };
+			std::tm		tm{};
+			::localtime_r(&t, &tm);
+			char		timestamp[32]{};
+			auto const	length{ std::strftime(timestamp, sizeof(timestamp), "%b %e %T", &tm) };
+
+			char		priority[8]{ '<' };
+			auto const	end{ std::to_chars(priority + 1, priority + sizeof(priority) - 1, static_cast<int>(option_.facility) * 8 + severity).ptr };
+			*end	= '>';
+			block_s.append(priority, end + 1);
+			block_s.append(timestamp, length).append(" ").append(ident_).append(line->text);
+			ends_s.push_back(block_s.size());
+		}
+		std::size_t	begin{};
+		for(auto const end : ends_s)
+		{
+			datagrams_s.emplace_back(block_s.data() + begin, end - begin);
+			begin	= end;
+		}
+		if( ! syslog_)
+		{
+			syslog_	= std::make_unique<syslog_t>(option_.path);
+		}
+		if( ! syslog_->send(datagrams_s))
+		{
+			throw std::system_error(std::make_error_code(std::errc::io_error), "syslog");
+		}
+#else
+		// unsupported platform.
+#endif
+	}
+private:
+	std::string					name_;		//< External logger name.
+#if defined(xxx_syslog_socket)
+	std::string					ident_;		//< Prefix of messages after the timestamp, i.e., 'ident[pid]: '.
+	::pid_t						pid_;		//< Process ID in the prefix, or zero before it is built.
+#endif
+	syslog_option_t				option_;	//< Options of syslog.
+#if defined(xxx_syslog_socket)
+	std::unique_ptr<syslog_t>	syslog_;	//< Connection to syslog daemon.
+#endif
+	std::mutex					mutex_;		//< Mutex.
+};
+
+//	Sink with its own background writer.
+class async_sink_t : public sink_t
+{
+public:
+	void	write(line_t const& line) override	{ worker_.push(line);	}
+	void
+	flush() override
+	{
+		worker_.flush();
+		sink_->flush();
+	}
+
+	//	Constructor.
+	//	@param[in]		sink		Sink to write lines.
+	//	@param[in]		capacity	Capacity of the queue.
+	//	@param[in]		overflow	Policy when the queue is full.
+	//	@param[in]		dropped		Counter of dropped lines.
+	async_sink_t(std::shared_ptr<sink_t> const& sink, std::size_t capacity, overflow_t overflow, std::atomic<std::uint64_t>* dropped) :
+		sink_t{}, sink_{ sink }, worker_{ capacity, overflow, [this](record_t const& record) { write_(record); }, dropped }
+	{}
+private:
+	void
+	write_(record_t const& record)
+	{
+		if(record.kind == kind_t::Line)
+		{
+			std::string_view const	text{ record.message };
+			sink_->write(line_t{ record.level, record.time, text.substr(record.offset, record.size), text, record.format });
+			return;
+		}
+		// e.g., notification of dropped records.
+		thread_local buffer_t		line_s;
+		thread_local timestamp_t	timestamp_s;
+		line_s.clear();
+		put_prefix(line_s, timestamp_s, record.time, record.level, nullptr);
+		line_s.write(record.message.data(), record.message.size());
+		auto const		text{ line_s.view() };
+		line_t const	line{ record.level, record.time, text.substr(text.size() - record.message.size()), text, format_t::Text };
+		if(sink_->accepts(line))
+		{
+			sink_->write(line);
+		}
+	}
+private:
+	std::shared_ptr<sink_t>		sink_;		//< Sink to write lines.
+	worker_t					worker_;	//< Background writer, which is destroyed first.
+};
+
+void
+flusher_t::run_()
+{
+	std::unique_lock	lock{ mutex_ };
+	while( ! stopping_)
+	{
+		cv_.wait_for(lock, interval_);
+		auto const	now{ file_t::clock_t::now() };
+		for(auto const file : files_)
+		{
+			ignore_exceptions([file, &now]() { file->flush_if_expired(now); });
+		}
+	}
+}
+
+//	Log-linear histogram of elapsed time in nanoseconds.
+//	Each power of two is divided into 32 buckets, so that the relative error is within about 3%.
+//	Only the owner thread records into it unless it is shared, and other threads read it without locks.
+class histogram_t
+{
+public:
+	static constexpr unsigned		sub_bits_{ 5u };	//< Bits of buckets per power of two.
+	static constexpr unsigned		max_bits_{ 41u };	//< Bits of the maximum value; larger values are clamped.
+	static constexpr std::size_t	size_{ ((max_bits_ - sub_bits_) << sub_bits_) + (std::size_t{ 1u } << (sub_bits_ + 1u)) - (std::size_t{ 1u } << sub_bits_) };	//< Number of buckets.
+
+	//	Gets the index of the bucket of the value.
+	static std::size_t
+	index_of(std::uint64_t value) noexcept
+	{
+		value	= std::min(value, (std::uint64_t{ 1u } << max_bits_) - 1u);
+		if(value < (std::uint64_t{ 1u } << (sub_bits_ + 1u)))
+		{
+			return static_cast<std::size_t>(value);
+		}
+		unsigned	msb{ sub_bits_ + 1u };
+		while((value >> (msb + 1u)) != 0u)	++msb;
+		return static_cast<std::size_t>(((msb - sub_bits_) << sub_bits_) + (value >> (msb - sub_bits_)));
+	}
+	//	Gets the largest value of the bucket.
+	static std::uint64_t
+	upper_of(std::size_t index) noexcept
+	{
+		if(index < (std::size_t{ 1u } << (sub_bits_ + 1u)))
+		{
+			return index;
+		}
+		auto const	shift{ (index >> sub_bits_) - 1u };
+		auto const	top{ (index & ((std::size_t{ 1u } << sub_bits_) - 1u)) + (std::size_t{ 1u } << sub_bits_) };
+		return ((std::uint64_t{ top } + 1u) << shift) - 1u;
+	}
+
+	//	Records a value by the owner thread.
+	void
+	record(std::uint64_t value) noexcept
+	{
+		add_(counts_[index_of(value)], 1u);
+		add_(count_, 1u);
+		add_(total_, value);
+		if(max_.load(std::memory_order_relaxed) < value)
+		{
+			max_.store(value, std::memory_order_relaxed);
+		}
+	}
+	//	Records a value by any thread.
+	void
+	record_shared(std::uint64_t value) noexcept
+	{
+		counts_[index_of(value)].fetch_add(1u, std::memory_order_relaxed);
+		count_.fetch_add(1u, std::memory_order_relaxed);
+		total_.fetch_add(value, std::memory_order_relaxed);
+		for(auto max{ max_.load(std::memory_order_relaxed) }; max < value && ! max_.compare_exchange_weak(max, value, std::memory_order_relaxed); )
+		{}
+	}
+	//	Merges into the profile.
+	void
+	merge_into(std::vector<std::uint64_t>& counts, profile_t& profile) const noexcept
+	{
+		for(std::size_t i{}; i < size_; ++i)
+		{
+			counts[i]	+= counts_[i].load(std::memory_order_relaxed);
+		}
+		profile.count	+= count_.load(std::memory_order_relaxed);
+		profile.total	+= std::chrono::nanoseconds{ total_.load(std::memory_order_relaxed) };
+		profile.max		= std::max(profile.max, std::chrono::nanoseconds{ max_.load(std::memory_order_relaxed) });
+	}
+	//	Merges another histogram into this one.
+	//	It must be called under exclusive access to this histogram.
+	void
+	merge(histogram_t const& other) noexcept
+	{
+		for(std::size_t i{}; i < size_; ++i)
+		{
+			add_(counts_[i], other.counts_[i].load(std::memory_order_relaxed));
+		}
+		add_(count_, other.count_.load(std::memory_order_relaxed));
+		add_(total_, other.total_.load(std::memory_order_relaxed));
+		max_.store(std::max(max_.load(std::memory_order_relaxed), other.max_.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+	}
+	//	Discards recorded values.
+	void
+	reset() noexcept
+	{
+		for(auto& count : counts_)
+		{
+			count.store(0u, std::memory_order_relaxed);
+		}
+		count_.store(0u, std::memory_order_relaxed);
+		total_.store(0u, std::memory_order_relaxed);
+		max_.store(0u, std::memory_order_relaxed);
+	}
+
+	histogram_t() noexcept = default;
+private:
+	// Adds without read-modify-write because there is a single writer.
+	static void
+	add_(std::atomic<std::uint64_t>& counter, std::uint64_t value) noexcept
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+private:
+	histogram_t(histogram_t const&)						= delete;
+	histogram_t const&	operator =(histogram_t const&)	= delete;
+private:
+	std::atomic<std::uint64_t>	counts_[size_]{};	//< Counts per bucket.
+	std::atomic<std::uint64_t>	count_{};			//< Number of values.
+	std::atomic<std::uint64_t>	total_{};			//< Sum of values.
+	std::atomic<std::uint64_t>	max_{};				//< Maximum value.
+};
+
+//	Gets a percentile of merged counts of histograms.
+//	@param[in]		counts		Counts per bucket.
+//	@param[in]		q			Quantile, e.g., 0.99.
+//	@param[in]		max			Maximum value.
+//	@return		The upper bound of the bucket of the percentile, which does not exceed the maximum.
+inline std::chrono::nanoseconds
+percentile_of(std::vector<std::uint64_t> const& counts, double q, std::chrono::nanoseconds max)
+{
+	// Sums of counts may differ from the count while other threads are recording.
+	auto const	sum{ std::accumulate(std::begin(counts), std::end(counts), std::uint64_t{}) };
+	auto const	rank{ std::max<std::uint64_t>(1u, static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(sum)))) };
+	std::uint64_t	accumulated{};
+	for(std::size_t i{}; i < counts.size(); ++i)
+	{
+		accumulated	+= counts[i];
+		if(rank <= accumulated)
+		{
+			return std::min(std::chrono::nanoseconds{ histogram_t::upper_of(i) }, max);
+		}
+	}
+	return max;
+}
+
+//	Number of slots of a ring of flight recorder.
+constexpr std::size_t	flight_slots{ 256u };
+//	Number of words of a message in a slot; longer text is truncated.
+constexpr std::size_t	flight_words{ 56u };
+
+//	Slot of a ring of flight recorder.
+//	All the members are atomic so that dumps can read them while the owner thread overwrites them.
+//	The sequence is odd while it is written, and twice the number of written slots after that.
+struct flight_slot_t
+{
+	std::atomic<std::uint64_t>			sequence{};		//< Sequence.
+	std::atomic<logger_t const*>		logger{};		//< Logger, which is only compared.
+	std::atomic<level_t>				level{};		//< Logging level.
+	std::atomic<kind_t>					kind{};			//< Kind of the message.
+	std::atomic<std::int64_t>			time{};			//< Time of logging in nanoseconds since the epoch.
+	std::atomic<char const*>			file{};			//< File name of the position of source, or nullptr.
+	std::atomic<char const*>			function{};		//< Function name of the position of source.
+	std::atomic<std::uint_least32_t>	line{};			//< Line of the position of source.
+	std::atomic<std::uint64_t>			site{};			//< Identifier of the position of source of binary record.
+	std::atomic<std::uint32_t>			size{};			//< Size of the message.
+	std::atomic<std::uint64_t>			data[flight_words]{};	//< Message.
+};
+
+//	Ring of flight recorder, which is written by a thread at once.
+//	It is reused by another thread after the owner exits, and never freed.
+struct flight_ring_t
+{
+	flight_slot_t					slots[flight_slots]{};	//< Slots.
+	std::atomic<std::uint64_t>		head{};		//< Number of written slots.
+	std::atomic<bool>				owned{};	//< Whether a thread owns it or not.
+	std::atomic<flight_ring_t*>		next{};		//< Next ring.
+};
+
+//	Entry read from a slot.
+struct flight_entry_t
+{
+	logger_t const*			logger;		//< Logger.
+	level_t					level;		//< Logging level.
+	kind_t					kind;		//< Kind of the message.
+	std::int64_t			time;		//< Time of logging in nanoseconds since the epoch.
+	char const*				file;		//< File name of the position of source, or nullptr.
+	char const*				function;	//< Function name of the position of source.
+	std::uint_least32_t		line;		//< Line of the position of source.
+	std::uint64_t			site;		//< Identifier of the position of source of binary record.
+	std::uint32_t			size;		//< Size of the message.
+	char					data[flight_words * sizeof(std::uint64_t)];	//< Message.
+};
+
+//	Writes a slot into the ring of the current thread.
+//	Binary records and JSON lines which are too long are not written because they cannot be truncated.
+inline void
+write_flight(flight_ring_t& ring, logger_t const* logger, level_t level, kind_t kind, std::chrono::system_clock::time_point const& time, std::optional<sl::source_location> const& pos, std::uint64_t site, std::string_view message) noexcept
+{
+	constexpr std::size_t	capacity{ flight_words * sizeof(std::uint64_t) };
+	if(capacity < message.size() && kind != kind_t::Text)
+	{
+		return;
+	}
+	auto const	size{ std::min(message.size(), capacity) };
+
+	auto const	index{ ring.head.load(std::memory_order_relaxed) };
+	auto&		slot{ ring.slots[index % flight_slots] };
+	slot.sequence.store(2u * index + 1u, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot.logger.store(logger, std::memory_order_relaxed);
+	slot.level.store(level, std::memory_order_relaxed);
+	slot.kind.store(kind, std::memory_order_relaxed);
+	slot.time.store(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count(), std::memory_order_relaxed);
+	slot.file.store(pos ? pos->file_name() : nullptr, std::memory_order_relaxed);
+	slot.function.store(pos ? pos->function_name() : nullptr, std::memory_order_relaxed);
+	slot.line.store(pos ? static_cast<std::uint_least32_t>(pos->line()) : 0u, std::memory_order_relaxed);
+	slot.site.store(site, std::memory_order_relaxed);
+	slot.size.store(static_cast<std::uint32_t>(size), std::memory_order_relaxed);
+	for(std::size_t offset{}; offset < size; offset += sizeof(std::uint64_t))
+	{
+		std::uint64_t	word{};
+		std::memcpy(&word, message.data() + offset, std::min(sizeof(word), size - offset));
+		slot.data[offset / sizeof(word)].store(word, std::memory_order_relaxed);
+	}
+
+	slot.sequence.store(2u * (index + 1u), std::memory_order_release);
+	ring.head.store(index + 1u, std::memory_order_release);
+}
+
+//	Reads slots of a ring in order.
+//	Slots overwritten while reading are skipped.
+//	It neither allocates memory nor locks.
+//	@param[in]		ring		Ring.
+//	@param[out]		entry		Entry to read a slot.
+//	@param[in]		f			Function object to consume the entry.
+//	@param[in]		from		Number of slots which have been read before.
+//	@return		Number of slots written into the ring when it is read, which is the next value of the from.
+template<typename F>
+inline std::uint64_t
+read_flight(flight_ring_t const& ring, flight_entry_t& entry, F const& f, std::uint64_t from=0u)
+{
+	auto const	head{ ring.head.load(std::memory_order_acquire) };
+	for(auto index{ std::max<std::uint64_t>(from, head < flight_slots ? 0u : head - flight_slots) }; index < head; ++index)
+	{
+		auto const&	slot{ ring.slots[index % flight_slots] };
+		auto const	sequence{ slot.sequence.load(std::memory_order_acquire) };
+		if(sequence != 2u * (index + 1u))
+		{
+			continue;
+		}
+		entry.logger	= slot.logger.load(std::memory_order_relaxed);
+		entry.level		= slot.level.load(std::memory_order_relaxed);
+		entry.kind		= slot.kind.load(std::memory_order_relaxed);
+		entry.time		= slot.time.load(std::memory_order_relaxed);
+		entry.file		= slot.file.load(std::memory_order_relaxed);
+		entry.function	= slot.function.load(std::memory_order_relaxed);
+		entry.line		= slot.line.load(std::memory_order_relaxed);
+		entry.site		= slot.site.load(std::memory_order_relaxed);
+		entry.size		= std::min<std::uint32_t>(slot.size.load(std::memory_order_relaxed), sizeof(entry.data));
+		for(std::size_t offset{}; offset < entry.size; offset += sizeof(std::uint64_t))
+		{
+			auto const	word{ slot.data[offset / sizeof(std::uint64_t)].load(std::memory_order_relaxed) };
+			std::memcpy(entry.data + offset, &word, sizeof(word));
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if(slot.sequence.load(std::memory_order_relaxed) == sequence)
+		{
+			f(entry);
+		}
+	}
+	return head;
+}
+
+//	Rings of flight recorder of all the threads.
+//	The rings are linked without locks so that they can be dumped in a signal handler.
+class flight_recorder_t
+{
+public:
+	//	Acquires a ring for the current thread.
+	//	@return		Ring, which is not owned by others.
+	flight_ring_t*
+	acquire()
+	{
+		for(auto ring{ head_.load(std::memory_order_acquire) }; ring != nullptr; ring = ring->next.load(std::memory_order_acquire))
+		{
+			if(bool owned{}; ring->owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+			{
+				return ring;
+			}
+		}
+		auto const	ring{ new flight_ring_t{} };	// never freed.
+		ring->owned.store(true, std::memory_order_relaxed);
+		auto		next{ head_.load(std::memory_order_relaxed) };
+		do
+		{
+			ring->next.store(next, std::memory_order_relaxed);
+		} while( ! head_.compare_exchange_weak(next, ring, std::memory_order_release, std::memory_order_relaxed));
+		return ring;
+	}
+	//	Releases a ring of the current thread.
+	//	Its slots are kept until another thread overwrites them.
+	//	@param[in]		ring		Ring.
+	void	release(flight_ring_t* ring) noexcept	{ ring->owned.store(false, std::memory_order_release);	}
+	//	Visits all the rings.
+	//	@param[in]		f			Function object to visit a ring.
+	template<typename F>
+	void
+	for_each(F const& f) const
+	{
+		for(auto ring{ head_.load(std::memory_order_acquire) }; ring != nullptr; ring = ring->next.load(std::memory_order_acquire))
+		{
+			f(*ring);
+		}
+	}
+
+	constexpr flight_recorder_t() noexcept : head_{ nullptr } {}
+private:
+	std::atomic<flight_ring_t*>		head_;		//< The latest ring.
+};
+
+//	Flight recorder, which is initialized as a constant, and never destroyed.
+flight_recorder_t	flight_recorder_s;
+
+//	Ring of flight recorder of the current thread.
+class local_flight_t
+{
+public:
+	//	Gets the ring, which is acquired at the first time.
+	//	@return		Ring.
+	flight_ring_t&
+	ring()
+	{
+		if(ring_ == nullptr)
+		{
+			ring_	= flight_recorder_s.acquire();
+		}
+		return *ring_;
+	}
+
+	local_flight_t() : ring_{} {}
+	~local_flight_t()
+	{
+		if(ring_ != nullptr)
+		{
+			flight_recorder_s.release(ring_);
+		}
+	}
+private:
+	local_flight_t(local_flight_t const&)						= delete;
+	local_flight_t const&	operator =(local_flight_t const&)	= delete;
+private:
+	flight_ring_t*		ring_;		//< Ring, or nullptr before the first recording.
+};
+
+//	Number of shards of counters.
+constexpr std::size_t	shards{ 16u };
+
+//	Gets the shard of the current thread.
+//	@return		Index of the shard.
+inline std::size_t
+shard_index() noexcept
+{
+	static std::atomic<std::size_t>	next_s{};
+	thread_local std::size_t const	index_s{ next_s.fetch_add(1u, std::memory_order_relaxed) % shards };
+	return index_s;
+}
+
+//	Counters of a sink attached to a logger.
+class sink_counters_t
+{
+public:
+	//	Counts a line filtered out.
+	void	filter() noexcept	{ shards_[shard_index()].filtered.fetch_add(1u, std::memory_order_relaxed);	}
+	//	Writes lines, and counts them.
+	//	A failed write is counted as an error instead of being thrown.
+	//	@param[in]		lines		Number of lines.
+	//	@param[in]		bytes		Number of bytes.
+	//	@param[in]		write		Function object to write the lines.
+	template<typename F>
+	void
+	write(std::size_t lines, std::size_t bytes, F const& write) noexcept
+	{
+		thread_local std::uint32_t	tick_s{};
+		auto&		shard{ shards_[shard_index()] };
+		auto const	sampled{ (tick_s++ & 7u) == 0u };
+		auto const	start{ sampled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{} };
+		try
+		{
+			write();
+			shard.lines.fetch_add(lines, std::memory_order_relaxed);
+			shard.bytes.fetch_add(bytes, std::memory_order_relaxed);
+		}
+		catch(...)
+		{
+			shard.errors.fetch_add(1u, std::memory_order_relaxed);
+		}
+		if(sampled)
+		{
+			auto const	elapsed{ std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() };
+			latency_.record_shared(static_cast<std::uint64_t>(std::max<std::chrono::nanoseconds::rep>(elapsed, 0)));
+		}
+	}
+	//	Gets the counter of lines dropped by the queue of the sink.
+	//	@return		Counter.
+	auto	dropped() noexcept	{ return &dropped_;	}
+	//	Gets metrics.
+	//	@param[in]		name		Name of the sink.
+	//	@return		Metrics.
+	sink_metrics_t
+	metrics(char const* name) const
+	{
+		sink_metrics_t	metrics{};
+		metrics.name	= name;
+		for(auto const& shard : shards_)
+		{
+			metrics.lines		+= shard.lines.load(std::memory_order_relaxed);
+			metrics.bytes		+= shard.bytes.load(std::memory_order_relaxed);
+			metrics.filtered	+= shard.filtered.load(std::memory_order_relaxed);
+			metrics.errors		+= shard.errors.load(std::memory_order_relaxed);
+		}
+		metrics.dropped	= dropped_.load(std::memory_order_relaxed);
+
+		std::vector<std::uint64_t>	counts(histogram_t::size_);
+		profile_t					profile;
+		latency_.merge_into(counts, profile);
+		metrics.samples	= profile.count;
+		metrics.max		= profile.max;
+		if(0u < profile.count)
+		{
+			metrics.p50	= percentile_of(counts, 0.5, profile.max);
+			metrics.p99	= percentile_of(counts, 0.99, profile.max);
+		}
+		return metrics;
+	}
+
+	sink_counters_t() noexcept : shards_{}, dropped_{}, latency_{} {}
+private:
+	sink_counters_t(sink_counters_t const&)						= delete;
+	sink_counters_t const&	operator =(sink_counters_t const&)	= delete;
+private:
+	struct alignas(64) shard_t
+	{
+		std::atomic<std::uint64_t>	lines{};		//< Number of written lines.
+		std::atomic<std::uint64_t>	bytes{};		//< Number of written bytes.
+		std::atomic<std::uint64_t>	filtered{};		//< Number of lines filtered out.
+		std::atomic<std::uint64_t>	errors{};		//< Number of failed writes.
+	};
+private:
+	shard_t						shards_[shards];	//< Counters sharded per thread.
+	std::atomic<std::uint64_t>	dropped_;			//< Number of dropped lines.
+	histogram_t					latency_;			//< Latency of sampled writes.
+};
+
+//	Counters of a logger.
+class counters_t
+{
+public:
+	//	Counts a record.
+	//	@param[in]		level		Logging level.
+	void	count(level_t level) noexcept	{ shards_[shard_index()].records[static_cast<std::size_t>(level)].fetch_add(1u, std::memory_order_relaxed);	}
+	//	Counts a record kept by the flight recorder.
+	void	record() noexcept				{ shards_[shard_index()].recorded.fetch_add(1u, std::memory_order_relaxed);	}
+	//	Counts a record suppressed by a rate limit.
+	void	suppress() noexcept				{ shards_[shard_index()].suppressed.fetch_add(1u, std::memory_order_relaxed);	}
+	//	Gets the counter of records dropped by the asynchronous queue.
+	//	@return		Counter.
+	auto	dropped() noexcept				{ return &dropped_;	}
+	//	Gets metrics without sinks.
+	//	@return		Metrics.
+	metrics_t
+	metrics() const
+	{
+		metrics_t	metrics{};
+		for(auto const& shard : shards_)
+		{
+			for(std::size_t i{}; i < metrics.records.size(); ++i)
+			{
+				metrics.records[i]	+= shard.records[i].load(std::memory_order_relaxed);
+			}
+			metrics.recorded	+= shard.recorded.load(std::memory_order_relaxed);
+			metrics.suppressed	+= shard.suppressed.load(std::memory_order_relaxed);
+		}
+		metrics.dropped	= dropped_.load(std::memory_order_relaxed);
+		return metrics;
+	}
+
+	counters_t() noexcept : console{}, file{}, external{}, shards_{}, dropped_{} {}
+private:
+	counters_t(counters_t const&)						= delete;
+	counters_t const&	operator =(counters_t const&)	= delete;
+public:
+	sink_counters_t		console;		//< Counters of the sink of standard error.
+	sink_counters_t		file;			//< Counters of the sink of log file.
+	sink_counters_t		external;		//< Counters of the sink of the external logger.
+private:
+	struct alignas(64) shard_t
+	{
+		std::atomic<std::uint64_t>	records[10]{};	//< Number of records per level.
+		std::atomic<std::uint64_t>	recorded{};		//< Number of records kept by the flight recorder.
+		std::atomic<std::uint64_t>	suppressed{};	//< Number of records suppressed by rate limits.
+	};
+private:
+	shard_t						shards_[shards];	//< Counters sharded per thread.
+	std::atomic<std::uint64_t>	dropped_;			//< Number of dropped records.
+};
+
+//	Sink attached to a logger.
+struct attached_sink_t
+{
+	std::unique_ptr<sink_counters_t>	counters;	//< Counters of the sink, which outlive the writer.
+	std::shared_ptr<sink_t>				sink;		//< Attached sink.
+	std::shared_ptr<sink_t>				writer;		//< Writer of the sink, e.g., with its own background writer.
+};
+
+//	States of rate limits per position of source.
+//	Each position has a token bucket as the generic cell rate algorithm,
+//	i.e., the theoretical arrival time of the next line in a single atomic variable.
+//	Positions are kept in an open-addressing table without locks, and never removed.
+class limiter_t
+{
+public:
+	//	Number of positions to track.
+	static constexpr std::size_t	capacity_{ 1024u };
+
+	//	Sets rate limit of the level.
+	//	@param[in]		level		Logging level.
+	//	@param[in]		limit		Rate limit.
+	void
+	set(level_t level, rate_limit_t const& limit) noexcept
+	{
+		auto const	period{ std::chrono::duration_cast<std::chrono::nanoseconds>(limit.period).count() };
+		auto const	interval{ limit.burst == 0u ? 0 : std::max<std::int64_t>(period / limit.burst, 1) };
+		auto&		l{ limits_[static_cast<std::size_t>(level)] };
+		l.burst.store(limit.burst, std::memory_order_relaxed);
+		l.period.store(limit.period.count(), std::memory_order_relaxed);
+		l.interval.store(interval, std::memory_order_relaxed);
+		l.tolerance.store(interval * (static_cast<std::int64_t>(limit.burst) - 1), std::memory_order_relaxed);
+	}
+	//	Gets rate limit of the level.
+	//	@param[in]		level		Logging level.
+	//	@return		Rate limit.
+	rate_limit_t
+	get(level_t level) const noexcept
+	{
+		auto const&	l{ limits_[static_cast<std::size_t>(level)] };
+		return rate_limit_t{ l.burst.load(std::memory_order_relaxed), std::chrono::milliseconds{ l.period.load(std::memory_order_relaxed) } };
+	}
+	//	Takes a token of the position.
+	//	@param[in]		level		Logging level.
+	//	@param[in]		pos			Position of source.
+	//	@return		If the line is suppressed, it returns nullopt;
+	//				otherwise, it returns the number of lines suppressed since the previous written line.
+	std::optional<std::uint64_t>
+	take(level_t level, sl::source_location const& pos) noexcept
+	{
+		auto const&	l{ limits_[static_cast<std::size_t>(level)] };
+		auto const	interval{ l.interval.load(std::memory_order_relaxed) };
+		if(interval == 0)
+		{
+			return 0u;		// no limit, which does not claim a slot.
+		}
+		auto const	slot{ find_(level, pos) };
+		if(slot == nullptr)
+		{
+			return 0u;		// too many positions.
+		}
+		auto const	tolerance{ l.tolerance.load(std::memory_order_relaxed) };
+		auto const	now{ std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() };
+		auto		tat{ slot->tat.load(std::memory_order_relaxed) };
+		do
+		{
+			auto const	base{ std::max(tat, now) };
+			if(now + tolerance < base)
+			{
+				slot->suppressed.fetch_add(1u, std::memory_order_relaxed);
+				return std::nullopt;
+			}
+			if(slot->tat.compare_exchange_weak(tat, base + interval, std::memory_order_relaxed))
+			{
+				break;
+			}
+		} while(true);
+		return slot->suppressed.exchange(0u, std::memory_order_relaxed);
+	}
+	//	Takes the numbers of suppressed lines of all the positions.
+	//	@param[in]		f			Function object which takes level, position, and the number.
+	template<typename F>
+	void
+	drain(F const& f)
+	{
+		for(auto& slot : slots_)
+		{
+			if(slot.state.load(std::memory_order_acquire) != ready_)
+			{
+				continue;
+			}
+			if(auto const n{ slot.suppressed.exchange(0u, std::memory_order_relaxed) }; 0u < n)
+			{
+				f(slot.level, *slot.pos, n);
+			}
+		}
+	}
+
+	limiter_t() noexcept : limits_{}, slots_{} {}
+private:
+	limiter_t(limiter_t const&)						= delete;
+	limiter_t const&	operator =(limiter_t const&)	= delete;
+private:
+	//	States of slot.
+	static constexpr std::uint32_t	empty_{ 0u }, claiming_{ 1u }, ready_{ 2u };
+
+	struct limit_t
+	{
+		std::atomic<std::uint32_t>	burst{};		//< Number of lines written at once.
+		std::atomic<std::int64_t>	period{};		//< Period in milliseconds.
+		std::atomic<std::int64_t>	interval{};		//< Interval of lines in nanoseconds, or zero if it is not limited.
+		std::atomic<std::int64_t>	tolerance{};	//< Tolerance of bursts in nanoseconds.
+	};
+	struct slot_t
+	{
+		std::atomic<std::uint32_t>	state{};		//< State, which publishes the position.
+		level_t						level{};		//< Logging level at the position.
+		std::optional<sl::source_location>	pos{};	//< Position of source.
+		std::atomic<std::int64_t>	tat{};			//< Theoretical arrival time of the next line in nanoseconds.
+		std::atomic<std::uint64_t>	suppressed{};	//< Number of lines suppressed since the previous written line.
+	};
+
+	//	Finds or adds the slot of the position at the level.
+	//	A position logged at several levels has a slot per level.
+	//	@param[in]		level		Logging level.
+	//	@param[in]		pos			Position of source.
+	//	@return		Slot, or nullptr if the table is full or the slot is being added by another thread.
+	slot_t*
+	find_(level_t level, sl::source_location const& pos) noexcept
+	{
+		// File and function names are static strings, so they are compared by their addresses.
+		auto const	hash{ std::hash<void const*>{}(pos.file_name()) ^ std::hash<void const*>{}(pos.function_name()) * 31u ^ pos.line() * 0x9E3779B1u ^ static_cast<std::size_t>(level) * 0x85EBCA6Bu };
+		for(std::size_t i{}; i < capacity_; ++i)
+		{
+			auto&	slot{ slots_[(hash + i) % capacity_] };
+			auto	state{ slot.state.load(std::memory_order_acquire) };
+			if(state == empty_ && slot.state.compare_exchange_strong(state, claiming_, std::memory_order_acquire))
+			{
+				slot.level	= level;
+				slot.pos	= pos;
+				slot.state.store(ready_, std::memory_order_release);
+				return &slot;
+			}
+			if(state == claiming_)
+			{
+				return nullptr;
+			}
+			if(slot.level == level && slot.pos->file_name() == pos.file_name() && slot.pos->function_name() == pos.function_name() && slot.pos->line() == pos.line())
+			{
+				return &slot;
+			}
+		}
+		return nullptr;
+	}
+private:
+	limit_t		limits_[10];			//< Rate limits per level.
+	slot_t		slots_[capacity_];		//< Table of positions.
+};
+
+}	// namespace impl
+
+logger_t::logger_t(level_t level, std::filesystem::path const& path, std::string const&logger, bool console) :
+	level_{level}, clock_{clock_source_t::Realtime}, binary_{false}, profiling_{false}, recorder_{level_t::Silent}, format_{format_t::Text}, limited_{}, path_{path}, logger_{logger}, console_{console}, mutex_{}, recorded_{}, file_option_{}, syslog_option_{},
+	console_sink_{ std::make_unique<impl::console_sink_t>() }, file_sink_{ std::make_unique<impl::file_sink_t>() }, external_sink_{ std::make_unique<impl::external_sink_t>() }, sinks_{}, attached_{}, sinks_mutex_{}, counters_{ std::make_unique<impl::counters_t>() }, limiter_{}, worker_{}, batcher_{}
+{
+	file_sink_->open(path_, file_option_);
+	external_sink_->set_name(logger_);
+}
+
+logger_t::logger_t() :
+	level_{level_t::Info}, clock_{clock_source_t::Realtime}, binary_{false}, profiling_{false}, recorder_{level_t::Silent}, format_{format_t::Text}, limited_{}, path_{}, logger_{}, console_{true}, mutex_{}, recorded_{}, file_option_{}, syslog_option_{},
+	console_sink_{ std::make_unique<impl::console_sink_t>() }, file_sink_{ std::make_unique<impl::file_sink_t>() }, external_sink_{ std::make_unique<impl::external_sink_t>() }, sinks_{}, attached_{}, sinks_mutex_{}, counters_{ std::make_unique<impl::counters_t>() }, limiter_{}, worker_{}, batcher_{}
+{}
+
+logger_t::~logger_t()
+{
+	summarize_();		// the suppressed lines are summarized as flush() does.
+	worker_.reset();
+	batcher_.reset();
+	sinks_.clear();		// writes the queued lines of the sinks.
+	file_sink_.reset();
+}
+
+void
+logger_t::set_logger(std::string const& logger)
+{
+	std::lock_guard	lock{ mutex_ };
+	external_sink_->set_name(logger);
+	logger_	= logger;
+}
+
+void
+logger_t::set_path(std::filesystem::path const& path)
+{
+	std::lock_guard	lock{ mutex_ };
+	file_sink_->open(path, file_option_);
+	path_	= path;
+}
+
+void
+logger_t::set_file_option(file_option_t const& option)
+{
+	std::lock_guard	lock{ mutex_ };
+	file_sink_->open(path_, option);
+	file_option_	= option;
+}
+
+void
+logger_t::set_syslog_option(syslog_option_t const& option)
+{
+	std::lock_guard	lock{ mutex_ };
+	external_sink_->set_option(option);
+	syslog_option_	= option;
+}
+
+void
+logger_t::add_sink(std::shared_ptr<sink_t> const& sink, std::size_t capacity, overflow_t overflow)
+{
+	validate_argument(sink != nullptr);
+
+	auto	counters{ std::make_unique<impl::sink_counters_t>() };
+	auto	writer{ 0u < capacity ? std::make_shared<impl::async_sink_t>(sink, capacity, overflow, counters->dropped()) : sink };
+	std::unique_lock	lock{ sinks_mutex_ };
+	validate_argument(std::none_of(std::begin(sinks_), std::end(sinks_), [&sink](auto const& s) { return s.sink == sink; }));
+	sinks_.push_back(impl::attached_sink_t{ std::move(counters), sink, std::move(writer) });
+	attached_.store(sinks_.size(), std::memory_order_relaxed);
+}
+
+void
+logger_t::remove_sink(std::shared_ptr<sink_t> const& sink)
+{
+	if(batcher_)
+	{
+		batcher_->flush();	// the gathered lines may be written into the sink.
+	}
+	impl::attached_sink_t	attached;
+	{
+		std::unique_lock	lock{ sinks_mutex_ };	// waits for the lines being written.
+		auto const	itr{ std::find_if(std::begin(sinks_), std::end(sinks_), [&sink](auto const& s) { return s.sink == sink; }) };
+		validate_argument(itr != std::end(sinks_));
+		attached	= std::move(*itr);
+		sinks_.erase(itr);
+		attached_.store(sinks_.size(), std::memory_order_relaxed);
+	}
+	// The queued lines of the sink are written here.
+}
+
+sink_t&		logger_t::console_sink() noexcept	{ return *console_sink_;	}
+sink_t&		logger_t::file_sink() noexcept		{ return *file_sink_;	}
+sink_t&		logger_t::external_sink() noexcept	{ return *external_sink_;	}
+
+template<typename F>
+void
+logger_t::for_each_sink_(F const& f)
+{
+	if(console_)
+	{
+		f(*console_sink_, *console_sink_, counters_->console);
+	}
+	if(file_sink_->is_open())
+	{
+		f(*file_sink_, *file_sink_, counters_->file);
+	}
+	if( ! logger_.empty())
+	{
+		f(*external_sink_, *external_sink_, counters_->external);
+	}
+	if(attached_.load(std::memory_order_relaxed) == 0u)
+	{
+		return;
+	}
+	std::shared_lock	lock{ sinks_mutex_ };
+	for(auto const& attached : sinks_)
+	{
+		f(*attached.sink, *attached.writer, *attached.counters);
+	}
+}
+
+metrics_t
+logger_t::metrics() const
+{
+	auto	metrics{ counters_->metrics() };
+	metrics.sinks.push_back(counters_->console.metrics(console_sink_->name()));
+	metrics.sinks.push_back(counters_->file.metrics(file_sink_->name()));
+	metrics.sinks.push_back(counters_->external.metrics(external_sink_->name()));
+	std::shared_lock	lock{ sinks_mutex_ };
+	for(auto const& attached : sinks_)
+	{
+		metrics.sinks.push_back(attached.counters->metrics(attached.sink->name()));
+	}
+	return metrics;
+}
+
+void
+logger_t::set_rate_limit(level_t level, rate_limit_t const& limit)
+{
+	validate_argument(level != level_t::Silent);
+	validate_argument(limit.burst == 0u || std::chrono::milliseconds::zero() < limit.period);
+
+	auto const	first{ level == level_t::All ? level_t::Fatal : level };
+	auto const	last{ level == level_t::All ? level_t::Verbose : level };
+	std::lock_guard	lock{ mutex_ };
+	if( ! limiter_)
+	{
+		if(limit.burst == 0u)
+		{
+			return;		// no limit has been set.
+		}
+		limiter_	= std::make_unique<impl::limiter_t>();	// allocated on demand because it is large.
+	}
+	auto	limited{ limited_.load(std::memory_order_relaxed) };
+	for(auto l{ static_cast<int>(first) }; l <= static_cast<int>(last); ++l)
+	{
+		limiter_->set(static_cast<level_t>(l), limit);
+		limited	= limit.burst == 0u ? limited & ~(1u << l) : limited | (1u << l);
+	}
+	limited_.store(limited, std::memory_order_release);		// publishes the limiter.
+}
+
+rate_limit_t
+logger_t::rate_limit(level_t level) const
+{
+	validate_argument(level != level_t::Silent && level != level_t::All);
+	std::lock_guard	lock{ mutex_ };
+	return limiter_ ? limiter_->get(level) : rate_limit_t{};
+}
+
+void
+logger_t::summarize_()
+{
+	impl::limiter_t*	limiter{};
+	{
+		std::lock_guard	lock{ mutex_ };
+		limiter	= limiter_.get();	// it is never destroyed before the logger once allocated.
+	}
+	if(limiter == nullptr)
+	{
+		return;
+	}
+	limiter->drain([this](level_t level, sl::source_location const& pos, std::uint64_t suppressed)
+	{
+		ignore_exceptions([this, level, &pos, suppressed]() { log_(level, pos, "last message repeated " + std::to_string(suppressed) + " times"); });
+	});
+}
+
+bool
+logger_t::admit_(level_t level, sl::source_location const& pos)
+{
+	auto const	suppressed{ limiter_->take(level, pos) };
+	if( ! suppressed)
+	{
+		counters_->suppress();
+		return false;
+	}
+	if(0u < *suppressed)
+	{
+		log_(level, pos, "last message repeated " + std::to_string(*suppressed) + " times");
+	}
+	return true;
+}
+
+void
+logger_t::set_async(std::size_t capacity, overflow_t overflow)
+{
+	worker_.reset();	// writes the queued records.
+	if(0u < capacity)
+	{
+		worker_	= std::make_unique<impl::worker_t>(capacity, overflow, [this](impl::record_t const& record)
+		{
+			if(record.kind == impl::kind_t::Binary)
+			{
+				write_binary_(record.level, record.pos, record.time, record.message);
+			}
+			else if(record.kind == impl::kind_t::Json)
+			{
+				write_(record.level, record.pos, record.time, record.message, true);
+			}
+			else if(binary())
+			{
+				// e.g., notification of dropped records.
+				impl::encode_message(record.message, [this, &record](std::string_view payload) { write_binary_(record.level, record.pos, record.time, payload); });
+			}
+			else if(format() == format_t::Json)
+			{
+				impl::encode_json_message(record.message, [this, &record](std::string_view body) { write_(record.level, record.pos, record.time, body, true); });
+			}
+			else
+			{
+				write_(record.level, record.pos, record.time, record.message);
+			}
+		}, counters_->dropped());
+	}
+}
+
+void
+logger_t::set_batch(std::size_t size, std::chrono::milliseconds latency)
+{
+	batcher_.reset();	// writes the gathered lines.
+	if(0u < size)
+	{
+		batcher_	= std::make_unique<impl::batcher_t>(size, latency, [this](impl::batch_t const& batch)
+		{
+			thread_local std::vector<line_t>	lines_s;
+			thread_local std::vector<line_t>	accepted_s;
+			batch.lines(lines_s);
+			for_each_sink_([](sink_t& sink, sink_t& writer, impl::sink_counters_t& counters)
+			{
+				accepted_s.clear();
+				std::size_t	bytes{};
+				for(auto const& line : lines_s)
+				{
+					if( ! sink.accepts(line))
+					{
+						counters.filter();
+						continue;
+					}
+					accepted_s.push_back(line);
+					bytes	+= line.text.size() + 1u;
+				}
+				if( ! accepted_s.empty())
+				{
+					counters.write(accepted_s.size(), bytes, [&writer]() { writer.write_lines(accepted_s); });
+				}
+			});
+		});
+	}
+}
+
+void
+logger_t::flush()
+{
+	summarize_();
+	if(worker_)
+	{
+		worker_->flush();
+	}
+	if(batcher_)
+	{
+		batcher_->flush();
+	}
+	ignore_exceptions([this]() { console_sink_->flush(); });
+	ignore_exceptions([this]() { file_sink_->flush(); });
+	std::shared_lock	lock{ sinks_mutex_ };
+	for(auto const& attached : sinks_)
+	{
+		ignore_exceptions([&attached]() { attached.writer->flush(); });
+	}
+}
+
+void
+logger_t::log_(level_t level, std::optional<sl::source_location> const& pos, std::string_view message)
+{
+	validate_argument(level != level_t::Silent && level != level_t::All);
+	if(pos)
+	{
+		validate_argument(pos->file_name() != nullptr && pos->function_name() != nullptr);
+	}
+
+	if( ! enabled(level))
+	{
+		return;
+	}
+	if(binary())
+	{
+		impl::encode_message(message, [this, level, &pos](std::string_view payload) { log_binary_(level, pos, payload); });
+		return;
+	}
+	if(format() == format_t::Json)
+	{
+		impl::encode_json_message(message, [this, level, &pos](std::string_view body) { log_json_(level, pos, body); });
+		return;
+	}
+
+	auto const	now{ clock() == clock_source_t::Monotonic ? impl::calibrated_clock_t::now() : std::chrono::system_clock::now() };
+	if(record_(level, pos, now, message, impl::kind_t::Text))
+	{
+		return;
+	}
+	counters_->count(level);
+	if(worker_)
+	{
+		worker_->push(level, pos, now, message, impl::kind_t::Text);
+	}
+	else
+	{
+		write_(level, pos, now, message);
+	}
+}
+
+void
+logger_t::log_binary_(level_t level, std::optional<sl::source_location> const& pos, std::string_view payload)
+{
+	validate_argument(level != level_t::Silent && level != level_t::All);
+	if(pos)
+	{
+		validate_argument(pos->file_name() != nullptr && pos->function_name() != nullptr);
+	}
+
+	if( ! enabled(level))
+	{
+		return;
+	}
+
+	auto const	now{ clock() == clock_source_t::Monotonic ? impl::calibrated_clock_t::now() : std::chrono::system_clock::now() };
+	if(record_(level, pos, now, payload, impl::kind_t::Binary))
+	{
+		return;
+	}
+	counters_->count(level);
+	if(worker_)
+	{
+		worker_->push(level, pos, now, payload, impl::kind_t::Binary);
+	}
+	else
+	{
+		write_binary_(level, pos, now, payload);
+	}
+}
+
+void
+logger_t::log_json_(level_t level, std::optional<sl::source_location> const& pos, std::string_view body)
+{
+	validate_argument(level != level_t::Silent && level != level_t::All);
+	if(pos)
+	{
+		validate_argument(pos->file_name() != nullptr && pos->function_name() != nullptr);
+	}
+
+	if( ! enabled(level))
+	{
+		return;
+	}
+
+	auto const	now{ clock() == clock_source_t::Monotonic ? impl::calibrated_clock_t::now() : std::chrono::system_clock::now() };
+	if(record_(level, pos, now, body, impl::kind_t::Json))
+	{
+		return;
+	}
+	counters_->count(level);
+	if(worker_)
+	{
+		worker_->push(level, pos, now, body, impl::kind_t::Json);
+	}
+	else
+	{
+		write_(level, pos, now, body, true);
+	}
+}
+
+bool
+logger_t::record_(level_t level, std::optional<sl::source_location> const& pos, std::chrono::system_clock::time_point const& now, std::string_view message, impl::kind_t kind)
+{
+	if(static_cast<int>(level) <= static_cast<int>(level_.load(std::memory_order_relaxed)))
+	{
+		if(level == level_t::Fatal && recorder() != level_t::Silent)
+		{
+			dump_recorder();	// the context of the fatal error.
+		}
+		return false;
+	}
+	counters_->record();
+	ignore_exceptions([level, &pos, &now, message, kind, this]()
+	{
+		thread_local impl::local_flight_t	local_flight_s;
+		auto const	site{ kind == impl::kind_t::Binary && pos ? impl::sites_s.id(*pos) : 0u };
+		impl::write_flight(local_flight_s.ring(), this, level, kind, now, pos, site, message);
+	});
+	return true;
+}
+
+void
+logger_t::dump_recorder()
+{
+	std::vector<std::pair<impl::flight_entry_t, std::string>>	entries;
+	{
+		// The progress is tracked per ring rather than by time,
+		// because a thread may record a line stamped before the lines which have been dumped.
+		std::lock_guard			lock{ mutex_ };
+		impl::flight_entry_t	entry;
+		impl::flight_recorder_s.for_each([&entries, &entry, this](impl::flight_ring_t const& ring)
+		{
+			auto&	recorded{ recorded_[&ring] };
+			recorded	= impl::read_flight(ring, entry, [&entries, this](impl::flight_entry_t const& e)
+			{
+				if(e.logger == this)
+				{
+					entries.emplace_back(e, std::string(e.data, e.size));
+				}
+			}, recorded);
+		});
+	}
+	if(entries.empty())
+	{
+		return;
+	}
+	std::stable_sort(std::begin(entries), std::end(entries), [](auto const& lhs, auto const& rhs) { return lhs.first.time < rhs.first.time; });
+
+	if(worker_)
+	{
+		worker_->flush();	// keeps the order with the queued records.
+	}
+	for(auto const& [e, message] : entries)
+	{
+		auto const	time{ std::chrono::system_clock::time_point{} + std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds{ e.time }) };
+		if(e.kind == impl::kind_t::Binary)
+		{
+			write_binary_(e.level, e.site, time, message);
+		}
+		else if(e.file == nullptr)
+		{
+			write_(e.level, static_cast<impl::position_t const*>(nullptr), time, message, e.kind == impl::kind_t::Json);
+		}
+		else
+		{
+			impl::position_t const	position{ strip(e.file), e.line, e.function };
+			write_(e.level, &position, time, message, e.kind == impl::kind_t::Json);
+		}
+	}
+}
+
+void
+logger_t::write_binary_(level_t level, std::optional<sl::source_location> const& pos, std::chrono::system_clock::time_point const& now, std::string_view payload)
+{
+	write_binary_(level, pos ? impl::sites_s.id(*pos) : 0u, now, payload);
+}
+
+void
+logger_t::write_binary_(level_t level, std::uint64_t site, std::chrono::system_clock::time_point const& now, std::string_view payload)
+{
+	if( ! file_sink_->is_open())
+	{
+		return;
+	}
+	if(static_cast<int>(file_sink_->level()) < static_cast<int>(level))
+	{
+		counters_->file.filter();
+		return;
+	}
+	counters_->file.write(1u, payload.size(), [site, &payload, level, &now, this]()
+	{
+		file_sink_->write_binary(level, now, site, payload);
+	});
+}
+
+void
+logger_t::write_(level_t level, std::optional<sl::source_location> const& pos, std::chrono::system_clock::time_point const& now, std::string_view message, bool json)
+{
+	if(pos)
+	{
+		impl::position_t const	position{ strip(pos->file_name()), pos->line(), pos->function_name() };
+		write_(level, &position, now, message, json);
+	}
+	else
+	{
+		write_(level, static_cast<impl::position_t const*>(nullptr), now, message, json);
+	}
+}
+
+void
+logger_t::write_(level_t level, impl::position_t const* position, std::chrono::system_clock::time_point const& now, std::string_view message, bool json)
+{
+	thread_local impl::buffer_t		line_s;
+	thread_local impl::timestamp_t	timestamp_s;
+	line_s.clear();
+
+	auto const	put{ json ? impl::put_json_prefix : impl::put_prefix };
+	put(line_s, timestamp_s, now, level, position);
+	auto const	offset{ line_s.view().size() };
+	line_s.write(message.data(), message.size());
+	if(json)
+	{
+		line_s.write("}", 1u);
+	}
+	auto const		str{ line_s.view() };
+	line_t const	line{ level, now, str.substr(offset, message.size()), str, json ? format_t::Json : format_t::Text };
+
+	if(batcher_)
+	{
+		ignore_exceptions([&line, this]() { batcher_->append(line); });
+		return;
+	}
+	for_each_sink_([&line](sink_t& sink, sink_t& writer, impl::sink_counters_t& counters)
+	{
+		if( ! sink.accepts(line))
+		{
+			counters.filter();
+			return;
+		}
+		counters.write(1u, line.text.size() + 1u, [&line, &writer]() { writer.write(line); });
+	});
+}
+
+namespace impl {
+
+//	Immutable snapshot of loggers.
+class registry_t
+{
+public:
+	using	loggers_t	= std::map<std::string, std::shared_ptr<logger_t>, std::less<>>;
+
+	//	Finds a logger.
+	//	@param[in]		tag		Tag of logger.
+	//	@return		If found, it returns the logger; otherwise, it returns nullptr.
+	std::shared_ptr<logger_t> const*
+	find(std::string_view tag) const noexcept
+	{
+		auto const	itr{ index_.find(tag) };
+		return itr == std::end(index_) ? nullptr : itr->second;
+	}
+	//	Gets the loggers.
+	//	@return		Loggers.
+	auto const&		loggers() const noexcept	{ return loggers_;	}
+
+	//	Constructor.
+	//	@param[in]		loggers		Loggers.
+	explicit registry_t(loggers_t&& loggers) : loggers_{ std::move(loggers) }, index_{}
+	{
+		for(auto const& [tag, logger] : loggers_)
+		{
+			index_.emplace(tag, &logger);	// views the keys of the loggers_.
+		}
+	}
+private:
+	registry_t(registry_t const&)						= delete;
+	registry_t const&	operator =(registry_t const&)	= delete;
+private:
+	loggers_t const																loggers_;	//< Loggers.
+	std::unordered_map<std::string_view, std::shared_ptr<logger_t> const*>		index_;		//< Index of loggers.
+};
+
+//	Snapshot of loggers cached per thread.
+struct cache_t
+{
+	std::uint64_t						generation{};	//< Generation of the snapshot.
+	std::shared_ptr<registry_t const>	registry{};		//< Snapshot.
+};
+
+std::mutex							registry_mutex_s;		//< Mutex to update the registry.
+std::shared_ptr<registry_t const>	registry_s;				//< Current snapshot.
+std::atomic<std::uint64_t>			registry_generation_s{ 1u };	//< Generation of the current snapshot.
+thread_local cache_t				registry_cache_s;		//< Snapshot cached per thread.
+
+//	Flushes the loggers at exit even if other threads still refer them.
+struct drainer_t
+{
+	~drainer_t()
+	{
+		std::shared_ptr<registry_t const>	registry;
+		{
+			std::lock_guard	lock{ registry_mutex_s };
+			registry	= registry_s;
+		}
+		if(registry)
+		{
+			for(auto const& [tag, logger] : registry->loggers())
+			{
+				ignore_exceptions([&logger]() { logger->flush(); });
+			}
+		}
+	}
+} drainer_s;
+
+//	Gets the current snapshot.
+//	@return		Current snapshot.
+registry_t const&
+current_registry()
+{
+	auto&	cache{ registry_cache_s };
+	if(cache.generation != registry_generation_s.load(std::memory_order_acquire))
+	{
+		std::lock_guard	lock{ registry_mutex_s };
+		if( ! registry_s)
+		{
+			registry_t::loggers_t	loggers;
+			loggers.emplace("", std::make_shared<logger_t>());
+			registry_s	= std::make_shared<registry_t const>(std::move(loggers));
+		}
+		cache.registry		= registry_s;
+		cache.generation	= registry_generation_s.load(std::memory_order_relaxed);
+	}
+	return *cache.registry;
+}
+
+//	Publishes a new snapshot.
+//	@param[in]		update		Function object to update the loggers.
+template<typename F>
+void
+update_registry(F const& update)
+{
+	std::shared_ptr<registry_t const>	previous;	// released after unlock.
+	{
+		std::lock_guard			lock{ registry_mutex_s };
+		registry_t::loggers_t	loggers;
+		if(registry_s)
+		{
+			loggers	= registry_s->loggers();
+		}
+		else
+		{
+			loggers.emplace("", std::make_shared<logger_t>());
+		}
+		update(loggers);
+
+		previous	= std::exchange(registry_s, std::make_shared<registry_t const>(std::move(loggers)));
+		registry_generation_s.fetch_add(1u, std::memory_order_release);
+
+		registry_cache_s.registry	= registry_s;
+		registry_cache_s.generation	= registry_generation_s.load(std::memory_order_relaxed);
+	}
+}
+
+}	// namespace impl
+
+void
+add_logger(std::string const& tag, level_t level, std::filesystem::path const& path, std::string const& logger, bool console, std::size_t capacity, overflow_t overflow)
+{
+	validate_argument( ! tag.empty());
+
+	auto	l{ std::make_shared<logger_t>(level, path, logger, console) };
+	l->set_async(capacity, overflow);
+
+	impl::update_registry([&tag, &l](impl::registry_t::loggers_t& loggers)
+	{
+		validate_argument(loggers.find(tag) == std::end(loggers));
+		loggers.emplace(tag, std::move(l));
+	});
+}
+
+void
+remove_logger(std::string const& tag)
+{
+	validate_argument( ! tag.empty());
+
+	std::shared_ptr<logger_t>	removed;
+	impl::update_registry([&tag, &removed](impl::registry_t::loggers_t& loggers)
+	{
+		auto	itr{ loggers.find(tag) };
+		validate_argument(itr != std::end(loggers));
+		removed	= std::move(itr->second);
+		loggers.erase(itr);
+	});
+	removed->flush();	// writes the queued records even if it is still referred.
+}
+
+logger_t&
+logger(std::string_view tag)
+{
+	auto const	logger{ impl::current_registry().find(tag) };
+	validate_argument(logger != nullptr);
+	return **logger;
+}
+
+handle_t
+handle(std::string_view tag)
+{
+	auto const	logger{ impl::current_registry().find(tag) };
+	validate_argument(logger != nullptr);
+	return handle_t{ *logger };
+}
+
+namespace impl {
+
+//	Reader of binary log records.
+class reader_t
+{
+public:
+	//	Checks whether more bytes are available or not.
+	//	@return		If more bytes are available, it returns true; otherwise, it returns false.
+	bool
+	more()
+	{
+		return sb_->sgetc() != std::char_traits<char>::eof();
+	}
+	//	Reads a byte.
+	//	@return		Byte.
+	char
+	get()
+	{
+		auto const	ch{ sb_->sbumpc() };
+		validate_argument(ch != std::char_traits<char>::eof());
+		++count_;
+		return std::char_traits<char>::to_char_type(ch);
+	}
+	//	Reads an unsigned integer as LEB128.
+	//	@return		Value.
+	std::uint64_t
+	varint()
+	{
+		std::uint64_t	value{};
+		for(unsigned shift{}; ; shift += 7u)
+		{
+			validate_argument(shift < 64u);
+			auto const	byte{ static_cast<unsigned char>(get()) };
+			value	|= static_cast<std::uint64_t>(byte & 0x7Fu) << shift;
+			if((byte & 0x80u) == 0u)
+			{
+				return value;
+			}
+		}
+	}
+	//	Reads a fixed-size unsigned integer as little endian.
+	//	@param[in]		size	Size in bytes.
+	//	@return		Value.
+	std::uint64_t
+	fixed(std::size_t size)
+	{
+		std::uint64_t	value{};
+		for(std::size_t n{}; n < size; ++n)
+		{
+			value	|= static_cast<std::uint64_t>(static_cast<unsigned char>(get())) << (8u * n);
+		}
+		return value;
+	}
+	//	Reads a string with its length.
+	//	@param[out]		str		String.
+	void
+	string(std::string& str)
+	{
+		auto const	size{ static_cast<std::streamsize>(fixed(4u)) };
+		str.resize(static_cast<std::size_t>(size));
+		validate_argument(sb_->sgetn(str.data(), size) == size);
+		count_	+= static_cast<std::uint64_t>(size);
+	}
+	//	Gets the number of read bytes.
+	//	@return		Number of read bytes.
+	std::uint64_t	count() const noexcept	{ return count_;	}
+
+	//	Constructor.
+	//	@param[in,out]	is		Input stream.
+	explicit reader_t(std::istream& is) : sb_{ is.rdbuf() }, count_{}
+	{
+		validate_argument(sb_ != nullptr);
+	}
+private:
+	std::streambuf*		sb_;		//< Stream buffer.
+	std::uint64_t		count_;		//< Number of read bytes.
+};
+
+void	decode_value(reader_t& reader, buffer_t& buffer, std::string& work, unsigned depth);
+
+//	Decodes elements of a container.
+//	@param[in,out]	reader	Reader.
+//	@param[in,out]	buffer	Buffer to write text.
+//	@param[in,out]	work	Work area.
+//	@param[in]		depth	Depth of nested containers.
+//	@param[in]		open	Opening bracket.
+//	@param[in]		close	Closing bracket.
+//	@param[in]		pairs	Whether elements are key-value pairs or not.
+void
+decode_elements(reader_t& reader, buffer_t& buffer, std::string& work, unsigned depth, char open, char close, bool pairs)
+{
+	auto const	size{ reader.varint() };
+	buffer.write(&open, 1u);
+	for(std::uint64_t n{}; n < size; ++n)
+	{
+		if(0u < n)
+		{
+			buffer.write(",", 1u);
+		}
+		decode_value(reader, buffer, work, depth + 1u);
+		if(pairs)
+		{
+			buffer.write(":", 1u);
+			decode_value(reader, buffer, work, depth + 1u);
+		}
+	}
+	buffer.write(&close, 1u);
+}
+
+//	Decodes an argument into text as impl::dump_ does.
+//	@param[in,out]	reader	Reader.
+//	@param[in,out]	buffer	Buffer to write text.
+//	@param[in,out]	work	Work area.
+//	@param[in]		depth	Depth of nested containers.
+void
+decode_value(reader_t& reader, buffer_t& buffer, std::string& work, unsigned depth)
+{
+	validate_argument(depth < 64u);
+	switch(reader.get())
+	{
+	case tag::Bool:
+		buffer.write(reader.get() != 0 ? "1" : "0", 1u);
+		break;
+	case tag::Char:
+		{
+			auto const	ch{ reader.get() };
+			buffer.write(&ch, 1u);
+		}
+		break;
+	case tag::Signed:
+		{
+			auto const	value{ reader.varint() };
+			auto const	number{ static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1u) };
+			char		digits[24];
+			auto const	result{ std::to_chars(std::begin(digits), std::end(digits), number) };
+			buffer.write(digits, static_cast<std::size_t>(result.ptr - digits));
+		}
+		break;
+	case tag::Unsigned:
+		put_number(buffer, reader.varint(), 0u, ' ');
+		break;
+	case tag::Float:
+		{
+			auto const	bits{ reader.fixed(8u) };
+			double		number;
+			std::memcpy(&number, &bits, sizeof(number));
+			char		digits[std::numeric_limits<double>::max_exponent10 + 32];
+			auto const	result{ std::to_chars(std::begin(digits), std::end(digits), number, std::chars_format::general, 6) };
+			buffer.write(digits, static_cast<std::size_t>(result.ptr - digits));
+		}
+		break;
+	case tag::String:
+		reader.string(work);
+		buffer.write(work.data(), work.size());
+		break;
+	case tag::Vector:	decode_elements(reader, buffer, work, depth, '[', ']', false);	break;
+	case tag::Map:		decode_elements(reader, buffer, work, depth, '{', '}', true);	break;
+	case tag::Set:		decode_elements(reader, buffer, work, depth, '{', '}', false);	break;
+	case tag::Enclosed:	decode_elements(reader, buffer, work, depth, '(', ')', false);	break;
+	default:
+		throw std::invalid_argument(__func__);
+	}
+}
+
+}	// namespace impl
+
+void
+decode(std::istream& is, std::ostream& os)
+{
+	impl::reader_t		reader{ is };
+	impl::buffer_t		line;
+	impl::timestamp_t	timestamp;
+	std::string			work;
+	std::unordered_map<std::uint64_t, impl::site_t>	sites;
+
+	for(bool started{ false }; reader.more(); started = true)
+	{
+		auto const	tag{ reader.get() };
+		if(tag == impl::magic_s.front())
+		{
+			// Files may be concatenated.
+			for(auto const ch : impl::magic_s.substr(1u))
+			{
+				validate_argument(reader.get() == ch);
+			}
+			sites.clear();
+			continue;
+		}
+		validate_argument(started);
+
+		switch(tag)
+		{
+		case impl::tag::Site:
+			{
+				auto const		id{ reader.varint() };
+				impl::site_t	site;
+				site.line	= static_cast<std::uint_least32_t>(reader.varint());
+				reader.string(site.file);
+				reader.string(site.function);
+				sites[id]	= std::move(site);
+			}
+			break;
+		case impl::tag::Record:
+			{
+				auto const	id{ reader.varint() };
+				auto const	level{ reader.fixed(1u) };
+				validate_argument(level <= static_cast<std::uint64_t>(level_t::All));
+				auto const	time{ std::chrono::system_clock::time_point{} + std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds{ static_cast<std::int64_t>(reader.fixed(8u)) }) };
+				auto const	size{ reader.fixed(4u) };
+
+				line.clear();
+				if(id == 0u)
+				{
+					impl::put_prefix(line, timestamp, time, static_cast<level_t>(level), nullptr);
+				}
+				else
+				{
+					auto const	itr{ sites.find(id) };
+					validate_argument(itr != std::end(sites));
+					impl::position_t const	position{ itr->second.file, itr->second.line, itr->second.function };
+					impl::put_prefix(line, timestamp, time, static_cast<level_t>(level), &position);
+				}
+				auto const	begin{ reader.count() };
+				while(reader.count() - begin < size)
+				{
+					impl::decode_value(reader, line, work, 0u);
+				}
+				validate_argument(reader.count() - begin == size);
+				line.write("\n", 1u);
+
+				auto const	str{ line.view() };
+				os.write(str.data(), static_cast<std::streamsize>(str.size()));
+			}
+			break;
+		default:
+			throw std::invalid_argument(__func__);
+		}
+	}
+}
+
+namespace impl {
+
+//	Position of source as the key of histograms.
+//	The same position may have different addresses of names in different translation units,
+//	so that they are merged by names in snapshots.
+struct site_key_t
+{
+	char const*				file;		//< File name.
+	char const*				function;	//< Function name.
+	std::uint_least32_t		line;		//< Line.
+
+	bool	operator ==(site_key_t const& rhs) const noexcept	{ return file == rhs.file && function == rhs.function && line == rhs.line;	}
+};
+
+//	Hash of site_key_t.
+struct site_hash_t
+{
+	std::size_t
+	operator ()(site_key_t const& key) const noexcept
+	{
+		auto const	h{ std::hash<void const*>{}(key.file) ^ (std::hash<void const*>{}(key.function) * 31u) };
+		return h ^ (key.line * 0x9E3779B97F4A7C15ull);
+	}
+};
+
+//	Histograms of a position of source.
+struct site_profile_t
+{
+	site_key_t		key;		//< Position of source.
+	histogram_t		histogram;	//< Histogram.
+
+	explicit site_profile_t(site_key_t const& key) noexcept : key{ key }, histogram{} {}
+};
+
+//	Histograms recorded by a thread.
+struct thread_profile_t
+{
+	std::mutex						mutex;	//< Mutex to add sites and to read them by other threads.
+	std::deque<site_profile_t>		sites;	//< Histograms per position of source.
+};
+
+//	Profiles of all the threads.
+class profiler_t
+{
+public:
+	//	Gets the instance.
+	static profiler_t&
+	instance()
+	{
+		static profiler_t	profiler;
+		return profiler;
+	}
+	//	Attaches a thread.
+	std::shared_ptr<thread_profile_t>
+	attach()
+	{
+		auto			thread{ std::make_shared<thread_profile_t>() };
+		std::lock_guard	lock{ mutex_ };
+		threads_.push_back(thread);
+		return thread;
+	}
+	//	Detaches an exited thread, and keeps its histograms.
+	void
+	detach(std::shared_ptr<thread_profile_t> const& thread) noexcept
+	{
+		std::lock_guard	lock{ mutex_ };
+		ignore_exceptions([this, &thread]()
+		{
+			for(auto const& site : thread->sites)
+			{
+				retired_.try_emplace(site.key).first->second.merge(site.histogram);
+			}
+		});
+		threads_.erase(std::remove(std::begin(threads_), std::end(threads_), thread), std::end(threads_));
+	}
+	//	Merges histograms per position of source.
+	std::vector<profile_t>
+	snapshot()
+	{
+		using key_t	= std::tuple<std::string_view, std::uint_least32_t, std::string_view>;
+		std::map<key_t, std::pair<profile_t, std::vector<std::uint64_t>>>	merged;
+
+		auto const	merge{ [&merged](site_key_t const& key, histogram_t const& histogram)
+		{
+			auto&	[profile, counts]{ merged[key_t{ key.file, key.line, key.function }] };
+			if(counts.empty())
+			{
+				profile.file		= strip(key.file);	// the same as the prefix of lines.
+				profile.line		= key.line;
+				profile.function	= key.function;
+				counts.resize(histogram_t::size_);
+			}
+			histogram.merge_into(counts, profile);
+		} };
+		{
+			std::lock_guard	lock{ mutex_ };
+			for(auto const& [key, histogram] : retired_)
+			{
+				merge(key, histogram);
+			}
+			for(auto const& thread : threads_)
+			{
+				std::lock_guard	l{ thread->mutex };
+				for(auto const& site : thread->sites)
+				{
+					merge(site.key, site.histogram);
+				}
+			}
+		}
+
+		std::vector<profile_t>	profiles;
+		profiles.reserve(merged.size());
+		for(auto& [key, value] : merged)
+		{
+			auto&	[profile, counts]{ value };
+			if(profile.count == 0u)
+			{
+				continue;
+			}
+			profile.p50		= percentile_of(counts, 0.5, profile.max);
+			profile.p99		= percentile_of(counts, 0.99, profile.max);
+			profile.p999	= percentile_of(counts, 0.999, profile.max);
+			profiles.push_back(std::move(profile));
+		}
+		return profiles;
+	}
+	//	Discards histograms.
+	void
+	reset() noexcept
+	{
+		std::lock_guard	lock{ mutex_ };
+		retired_.clear();
+		for(auto const& thread : threads_)
+		{
+			std::lock_guard	l{ thread->mutex };
+			for(auto& site : thread->sites)
+			{
+				site.histogram.reset();
+			}
+		}
+	}
+private:
+	profiler_t() = default;
+	profiler_t(profiler_t const&)						= delete;
+	profiler_t const&	operator =(profiler_t const&)	= delete;
+private:
+	std::mutex												mutex_;		//< Mutex.
+	std::vector<std::shared_ptr<thread_profile_t>>			threads_;	//< Histograms of live threads.
+	std::unordered_map<site_key_t, histogram_t, site_hash_t>	retired_;	//< Histograms of exited threads.
+};
+
+//	Histograms of the current thread.
+class local_profile_t
+{
+public:
+	//	Finds or adds the histogram of the position of source.
+	histogram_t&
+	histogram(site_key_t const& key)
+	{
+		if(auto const itr{ index_.find(key) }; itr != std::end(index_))
+		{
+			return *itr->second;
+		}
+		histogram_t*	histogram{};
+		{
+			std::lock_guard	lock{ thread_->mutex };
+			histogram	= &thread_->sites.emplace_back(key).histogram;
+		}
+		index_.emplace(key, histogram);
+		return *histogram;
+	}
+
+	local_profile_t() : profiler_{ profiler_t::instance() }, thread_{ profiler_.attach() }, index_{} {}
+	~local_profile_t()	{ profiler_.detach(thread_);	}
+private:
+	local_profile_t(local_profile_t const&)						= delete;
+	local_profile_t const&	operator =(local_profile_t const&)	= delete;
+private:
+	profiler_t&											profiler_;	//< Profiler, which outlives this.
+	std::shared_ptr<thread_profile_t>					thread_;	//< Histograms shared with the profiler.
+	std::unordered_map<site_key_t, histogram_t*, site_hash_t>	index_;	//< Index of histograms without locks.
+};
+
+void
+record_profile(sl::source_location const& pos, std::chrono::steady_clock::duration elapsed) noexcept
+{
+	ignore_exceptions([&pos, elapsed]()
+	{
+		thread_local local_profile_t	local_profile_s;
+		auto const	ns{ std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() };
+		local_profile_s.histogram(site_key_t{ pos.file_name(), pos.function_name(), static_cast<std::uint_least32_t>(pos.line()) })
+			.record(static_cast<std::uint64_t>(std::max<std::chrono::nanoseconds::rep>(ns, 0)));
+	});
+}
+
+}	// namespace impl
+
+std::vector<profile_t>
+profile()
+{
+	return impl::profiler_t::instance().snapshot();
+}
+
+void
+reset_profile()
+{
+	impl::profiler_t::instance().reset();
+}
+
+void
+dump_profile(logger_t& logger, level_t level, sl::source_location const& pos)
+{
+	if( ! logger.enabled(level))
+	{
+		return;
+	}
+	for(auto const& p : profile())
+	{
+		logger.log(level, pos, "profile ", p.file, ':', p.line, ' ', p.function, " count=", p.count,
+			" p50=", p.p50.count(), "ns p99=", p.p99.count(), "ns p999=", p.p999.count(), "ns max=", p.max.count(), "ns");
+	}
+}
+
+void
+dump_recorder(void (*write)(char const* data, std::size_t size) noexcept) noexcept
+{
+	if(write == nullptr)
+	{
+		return;
+	}
+	impl::flight_entry_t	entry;
+	impl::flight_recorder_s.for_each([write, &entry](impl::flight_ring_t const& ring)
+	{
+		impl::read_flight(ring, entry, [write](impl::flight_entry_t const& e)
+		{
+			char const*	Lv[]{ "[S]", "[F]", "[E]", "[W]", "[N]", "[I]", "[D]", "[T]", "[V]", "[A]" };
+
+			char		buffer[32];
+			auto		p{ std::to_chars(buffer, buffer + 20, e.time / 1'000'000'000).ptr };
+			*p++	= '.';
+			auto const	ns{ e.time % 1'000'000'000 };
+			for(std::int64_t digit{ 100'000'000 }; 0 < digit; digit /= 10)
+			{
+				*p++	= static_cast<char>('0' + ns / digit % 10);
+			}
+			write(buffer, static_cast<std::size_t>(p - buffer));
+			write(Lv[static_cast<int>(e.level)], 3u);
+			if(e.file != nullptr)
+			{
+				auto const	file{ strip(e.file) };
+				write("{", 1u);
+				write(file.data(), file.size());
+				write(":", 1u);
+				p	= std::to_chars(buffer, buffer + sizeof(buffer), e.line).ptr;
+				write(buffer, static_cast<std::size_t>(p - buffer));
+				write("} ", 2u);
+				write(e.function, std::char_traits<char>::length(e.function));
+				write(" ", 1u);
+			}
+			if(e.kind == impl::kind_t::Binary)
+			{
+				write("(binary)", 8u);
+			}
+			else
+			{
+				write(e.data, e.size);
+			}
+			write("\n", 1u);
+		});
+	});
+}
+
+namespace impl {
+
+//	Writes metrics of the loggers in the registry, a line per logger and sink.
+//	@param[in]		log			Function object to log a line of arguments.
+template<typename F>
+void
+put_metrics(F const& log)
+{
+	std::string_view const	Lv[]{ "silent", "fatal", "error", "warn", "notice", "info", "debug", "trace", "verbose", "all" };
+
+	for(auto const& m : metrics())
+	{
+		std::string	records;
+		for(auto level{ static_cast<std::size_t>(level_t::Fatal) }; level <= static_cast<std::size_t>(level_t::Verbose); ++level)
+		{
+			records.append(Lv[level]).append("=").append(std::to_string(m.records[level])).append(" ");
+		}
+		log("metrics tag=", m.tag, ' ', records, "recorded=", m.recorded, " suppressed=", m.suppressed, " dropped=", m.dropped);
+		for(auto const& s : m.sinks)
+		{
+			log("metrics tag=", m.tag, " sink=", s.name, " lines=", s.lines, " bytes=", s.bytes, " filtered=", s.filtered, " errors=", s.errors,
+				" dropped=", s.dropped, " p50=", s.p50.count(), "ns p99=", s.p99.count(), "ns max=", s.max.count(), "ns");
+		}
+	}
+}
+
+//	Dumper of metrics in a background thread.
+class metrics_dumper_t
+{
+public:
+	//	Starts or stops dumps.
+	//	@param[in]		tag			Tag of logger to dump.
+	//	@param[in]		level		Logging level.
+	//	@param[in]		interval	Interval of dumps; zero stops them.
+	void
+	set(std::string const& tag, level_t level, std::chrono::milliseconds interval)
+	{
+		stop_();
+		if(interval <= std::chrono::milliseconds::zero())
+		{
+			return;
+		}
+		stopping_	= false;
+		thread_		= std::thread{ [this, tag, level, interval]() { run_(tag, level, interval); } };
+	}
+
+	metrics_dumper_t() : stopping_{ false }, mutex_{}, cv_{}, thread_{} {}
+	~metrics_dumper_t()		{ ignore_exceptions([this]() { stop_(); });	}
+private:
+	metrics_dumper_t(metrics_dumper_t const&)						= delete;
+	metrics_dumper_t const&	operator =(metrics_dumper_t const&)	= delete;
+private:
+	void
+	stop_()
+	{
+		if( ! thread_.joinable())
+		{
+			return;
+		}
+		{
+			std::lock_guard	lock{ mutex_ };
+			stopping_	= true;
+		}
+		cv_.notify_one();
+		thread_.join();
+	}
+	void
+	run_(std::string const& tag, level_t level, std::chrono::milliseconds interval)
+	{
+		std::unique_lock	lock{ mutex_ };
+		while( ! cv_.wait_for(lock, interval, [this]() { return stopping_; }))
+		{
+			ignore_exceptions([&tag, level]()
+			{
+				// The logger may have been removed since the previous dump.
+				auto const	logger{ current_registry().find(tag) };
+				if(logger != nullptr && (*logger)->enabled(level))
+				{
+					put_metrics([&logger, level](auto const&... args) { (*logger)->log(level, args...); });
+				}
+			});
+		}
+	}
+private:
+	bool						stopping_;	//< Whether the dumper thread is stopping or not.
+	std::mutex					mutex_;		//< Mutex.
+	std::condition_variable		cv_;		//< Condition to stop the dumper thread.
+	std::thread					thread_;	//< Dumper thread.
+};
+
+}	// namespace impl
+
+std::vector<metrics_t>
+metrics()
+{
+	std::vector<metrics_t>	metrics;
+	for(auto const& [tag, logger] : impl::current_registry().loggers())
+	{
+		metrics.push_back(logger->metrics());
+		metrics.back().tag	= tag;
+	}
+	return metrics;
+}
+
+void
+dump_metrics(logger_t& logger, level_t level, sl::source_location const& pos)
+{
+	if( ! logger.enabled(level))
+	{
+		return;
+	}
+	impl::put_metrics([&logger, level, &pos](auto const&... args) { logger.log(level, pos, args...); });
+}
+
+void
+set_metrics_dump(std::string const& tag, level_t level, std::chrono::milliseconds interval)
+{
+	validate_argument(level != level_t::Silent && level != level_t::All);
+
+	static std::mutex				mutex_s;
+	static impl::metrics_dumper_t	dumper_s;
+	std::lock_guard	lock{ mutex_s };
+	dumper_s.set(tag, level, interval);
+}
+
+#endif	// xxx_no_logging
+
+}	// namespace log
+}	// namespace xxx
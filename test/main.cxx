@@ -10,9 +10,47 @@
 #include <xxx/logger.hxx>
 #include <xxx/str.hxx>
 
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <map>
+#include <set>
+#include <sstream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(xxx_posix) && ! defined(xxx_standard_cpp_only)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+//	Number of allocations to test allocation-free paths.
+//	The replacements are not inlined, so that the optimizer does not pair operator new with std::free.
+std::atomic<std::size_t>	allocations_s{};
+
+[[gnu::noinline]] void*
+operator new(std::size_t size)
+{
+	++allocations_s;
+	if(auto const p{ std::malloc(size == 0u ? 1u : size) }; p != nullptr)
+	{
+		return p;
+	}
+	throw std::bad_alloc();
+}
+[[gnu::noinline]] void*	operator new[](std::size_t size)					{ return operator new(size);	}
+[[gnu::noinline]] void	operator delete(void* p) noexcept					{ std::free(p);	}
+[[gnu::noinline]] void	operator delete(void* p, std::size_t) noexcept		{ std::free(p);	}
+[[gnu::noinline]] void	operator delete[](void* p) noexcept					{ std::free(p);	}
+[[gnu::noinline]] void	operator delete[](void* p, std::size_t) noexcept	{ std::free(p);	}
 
 void
 test_version()
@@ -224,6 +262,831 @@ test_logger()
 	}
 }
 
+std::size_t
+count_lines(std::filesystem::path const& path)
+{
+	std::ifstream	ifs{ path };
+	std::size_t		lines{};
+	for(std::string line; std::getline(ifs, line); ++lines)
+		;
+	return lines;
+}
+
+void
+test_async_logger()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	for(auto const overflow : { xxx::log::overflow_t::Block, xxx::log::overflow_t::DropNewest, xxx::log::overflow_t::DropOldest })
+	{
+		std::filesystem::path const	path{ "test_async.log" };
+		std::filesystem::remove(path);
+
+		xxx::log::add_logger("async", xxx::log::level_t::Info, path, "", false, 16u, overflow);
+		auto&	logger	= xxx::log::logger("async");
+
+		std::vector<std::thread>	threads;
+		for(int t{}; t < 4; ++t)
+		{
+			threads.emplace_back([&logger, t]()
+			{
+				for(int n{}; n < 1000; ++n)
+				{
+					logger.info(xxx_logpos, "thread:", t, " count:", n);
+				}
+			});
+		}
+		for(auto& thread : threads)
+		{
+			thread.join();
+		}
+		logger.flush();
+		auto const	flushed{ count_lines(path) };
+		xxx::log::remove_logger("async");
+
+		std::cout << static_cast<int>(overflow) << ":" << (overflow == xxx::log::overflow_t::Block ? flushed == 4000u : 0u < flushed) << (flushed == count_lines(path)) << std::endl;
+	}
+}
+
+void
+test_file_logger()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	std::filesystem::path const	path{ "test_rotate.log" };
+	for(auto const& name : { "test_rotate.log", "test_rotate.log.1", "test_rotate.log.2", "test_rotate.log.3", "test_moved.log" })
+	{
+		std::filesystem::remove(name);
+	}
+
+	xxx::log::file_option_t	option;
+	option.buffer_size		= 256u;
+	option.rotation_size	= 1024u;
+	option.retention		= 2u;
+
+	xxx::log::add_logger("file", xxx::log::level_t::Info, path, "", false);
+	auto&	logger	= xxx::log::logger("file");
+	logger.set_file_option(option);
+	for(int n{}; n < 100; ++n)
+	{
+		logger.info(xxx_logpos, "count:", n);
+	}
+	logger.flush();
+
+	std::cout	<< std::filesystem::exists("test_rotate.log.1")
+				<< std::filesystem::exists("test_rotate.log.2")
+				<< ! std::filesystem::exists("test_rotate.log.3")
+				<< (std::filesystem::file_size(path) <= option.rotation_size) << std::endl;
+
+	logger.set_path("test_moved.log");
+	logger.err(xxx_logpos, "moved");	// Error is flushed immediately.
+	std::cout << count_lines("test_moved.log") << std::endl;
+
+	// A record out of order does not rotate the file of the current period.
+	std::filesystem::remove("test_moved.log.1");
+	option.rotation_size	= 0u;
+	option.rotation_period	= std::chrono::hours{ 1 };
+	logger.set_file_option(option);
+	auto const	now{ std::chrono::system_clock::now() };
+	logger.file_sink().write(xxx::log::line_t{ xxx::log::level_t::Info, now - std::chrono::hours{ 2 }, "late", "late", xxx::log::format_t::Text });
+	logger.info(xxx_logpos, "current");
+	logger.flush();
+	std::cout << std::filesystem::exists("test_moved.log.1") << count_lines("test_moved.log") << std::endl;
+	xxx::log::remove_logger("file");
+}
+
+void
+test_logger_registry()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	using namespace std::string_view_literals;
+
+	xxx::log::add_logger("registry", xxx::log::level_t::Silent, "", "", false);
+	auto const	handle{ xxx::log::handle("registry"sv) };
+
+	std::atomic<bool>			stop{ false };
+	std::atomic<std::size_t>	found{};
+	std::vector<std::thread>	threads;
+	for(int t{}; t < 4; ++t)
+	{
+		threads.emplace_back([&stop, &found, &handle]()
+		{
+			while( ! stop)
+			{
+				auto&	logger	= xxx::log::logger("registry"sv);
+				found	+= (&logger == &handle.get()) ? 1u : 0u;
+				handle->info(xxx_logpos, "silent");
+			}
+		});
+	}
+	for(int n{}; n < 100; ++n)
+	{
+		xxx::log::add_logger("temporary", xxx::log::level_t::Silent, "", "", false);
+		xxx::log::logger("temporary").info(xxx_logpos, "silent");
+		xxx::log::remove_logger("temporary");
+	}
+	stop	= true;
+	for(auto& thread : threads)
+	{
+		thread.join();
+	}
+	xxx::log::remove_logger("registry");
+	handle->info(xxx_logpos, "the handle is still available");
+
+	try
+	{
+		xxx::log::logger("registry"sv);
+	}
+	catch(std::invalid_argument const&)
+	{
+		std::cout << "expected exception occurred" << std::endl;
+	}
+	std::cout << (0u < found) << std::endl;
+}
+
+//	Sink which keeps messages.
+struct message_sink_t : xxx::log::sink_t
+{
+	std::vector<std::string>	messages;
+	void	write(xxx::log::line_t const& line) override	{ messages.emplace_back(line.message);	}
+};
+
+void
+test_logger_allocation()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	std::filesystem::path const	path{ "test_allocation.log" };
+	std::filesystem::remove(path);
+
+	xxx::log::add_logger("allocation", xxx::log::level_t::Info, path, "", false);
+	auto&	logger	= xxx::log::logger("allocation");
+
+	std::vector<int> const				v{ 1, 2, 3 };
+	std::map<std::string, int> const	m{ { "a", 1 }, { "b", 2 } };
+	logger.info(xxx_logpos, "warming up");
+
+	auto const	before{ allocations_s.load() };
+	for(int n{}; n < 100; ++n)
+	{
+		logger.info(xxx_logpos, "count:", n, " ratio:", n / 3.0, " flag:", true, " char:", 'c', " vector:", v, " map:", m);
+		logger.err(xxx_logpos, "error:", -n);
+	}
+	auto const	after{ allocations_s.load() };
+	xxx::log::remove_logger("allocation");
+
+	std::cout << (after - before) << ":" << count_lines(path) << std::endl;
+	std::cout << xxx::log::enclose(1, "a", 2.5, v, m) << std::endl;
+
+	// Manipulators change the format of the following arguments of the message only.
+	xxx::log::logger_t	console{ xxx::log::level_t::Info, "", "", false };
+	auto const	sink{ std::make_shared<message_sink_t>() };
+	console.add_sink(sink);
+	console.info(std::hex, 255, ' ', std::setw(4), "ab", ' ', std::setfill('0'), std::setw(3), 7, ' ', std::boolalpha, true, ' ', std::setprecision(3), 3.14159);
+	console.info(255, ' ', true, ' ', 3.14159, ' ', "ab");
+	for(auto const& message : sink->messages)
+	{
+		std::cout << message << std::endl;
+	}
+}
+
+//	Counts formatting.
+struct counter_t
+{
+	int&	count;
+	friend std::ostream&	operator <<(std::ostream& os, counter_t const& c)	{ ++c.count;	return os;	}
+};
+
+void
+test_logger_level()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	int		formatted{};
+	int		evaluated{};
+	auto	evaluate{ [&evaluated]() { return ++evaluated; } };
+
+	xxx::log::add_logger("level", xxx::log::level_t::Info, "", "", false);
+	auto&	logger	= xxx::log::logger("level");
+	logger.trace(xxx_logpos, counter_t{ formatted });
+	logger.verbose(counter_t{ formatted });
+	logger.log(xxx::log::level_t::Debug, xxx_logpos, counter_t{ formatted });
+	xxx_log(logger, xxx::log::level_t::Trace, evaluate(), counter_t{ formatted });
+	{
+		xxx::log::tracer_t	t(logger, xxx_logpos, counter_t{ formatted });
+		t.set_result(counter_t{ formatted });
+	}
+	std::cout << formatted << evaluated << logger.enabled(xxx::log::level_t::Trace) << std::endl;
+
+	logger.info(xxx_logpos, counter_t{ formatted });
+	xxx_log(logger, xxx::log::level_t::Info, evaluate(), counter_t{ formatted });
+	logger.set_level(xxx::log::level_t::Trace);
+	{
+		xxx::log::tracer_t	t(logger, xxx_logpos, counter_t{ formatted });
+	}
+	std::cout << formatted << evaluated << logger.enabled(xxx::log::level_t::Trace) << std::endl;
+	xxx::log::remove_logger("level");
+}
+
+void
+test_logger_clock()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	std::filesystem::path const	path{ "test_clock.log" };
+	std::filesystem::remove(path);
+
+	xxx::log::add_logger("clock", xxx::log::level_t::Info, path, "", false);
+	auto&	logger	= xxx::log::logger("clock");
+	logger.set_clock(xxx::log::clock_source_t::Monotonic);
+	for(int n{}; n < 1000; ++n)
+	{
+		logger.info("count:", n);
+	}
+	logger.set_clock(xxx::log::clock_source_t::Realtime);
+	logger.info("realtime");
+	xxx::log::remove_logger("clock");
+
+	// Timestamps have the same length and never go backwards.
+	std::ifstream	ifs{ path };
+	std::string		previous;
+	bool			ordered{ true };
+	for(std::string line; std::getline(ifs, line); previous = line.substr(0u, 31u))
+	{
+		ordered	= ordered && previous <= line.substr(0u, 31u) && line[31u] == '[';
+	}
+	std::cout << ordered << std::endl;
+}
+
+void
+test_binary_logger()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	std::filesystem::path const	text_path{ "test_text.log" };
+	std::filesystem::path const	binary_path{ "test_binary.log" };
+	std::filesystem::remove(text_path);
+	std::filesystem::remove(binary_path);
+
+	xxx::log::add_logger("text", xxx::log::level_t::Info, text_path, "", false);
+	xxx::log::add_logger("binary", xxx::log::level_t::Info, binary_path, "", false, 64u);
+	xxx::log::logger("binary").set_binary(true);
+
+	std::vector<int> const					v{ 1, -2, 3 };
+	std::map<std::string, double> const		m{ { "a", 0.5 }, { "b", 1e-10 } };
+	std::set<std::vector<char>> const		s{ { 'x', 'y' }, { 'z' } };
+	std::string const						str{ "string" };
+	for(auto const tag : { "text", "binary" })
+	{
+		auto&	logger	= xxx::log::logger(tag);
+		for(int n{}; n < 3; ++n)
+		{
+			logger.info(xxx_logpos, "count:", n, ' ', -1234567890123ll, ' ', 42u, ' ', true, ' ', 3.25f, ' ', 1e100);
+		}
+		logger.warn(xxx_logpos, v, m, s, str, std::string_view{ "view" }, static_cast<char const*>(nullptr), xxx::log::enclose(1, "2"));
+		logger.err(xxx_logpos, "message");
+		logger.info(xxx_logpos, "manipulated:", std::hex, 255, " ", std::setw(5), 7, ' ', v, ' ', std::showpoint, 2.5, ' ', 42);
+		logger.info(xxx_logpos, "count:", 255);		// the format is reset per record.
+		logger.notice("without position ", std::filesystem::path{ "fallback" });
+		logger.notice(std::string{ "text only" });
+	}
+	xxx::log::remove_logger("text");
+	xxx::log::remove_logger("binary");
+
+	std::ifstream		ifs{ binary_path, std::ios::binary };
+	std::ostringstream	oss;
+	xxx::log::decode(ifs, oss);
+
+	// Timestamps are skipped.
+	std::ifstream		expected{ text_path };
+	std::istringstream	actual{ oss.str() };
+	bool				same{ true };
+	std::size_t			lines{};
+	for(std::string e, a; std::getline(expected, e); ++lines)
+	{
+		same	= same && std::getline(actual, a) && e.substr(e.find('[')) == a.substr(a.find('['));
+	}
+	std::string		rest;
+	std::cout << same << ! std::getline(actual, rest) << lines << std::endl;
+
+	try
+	{
+		std::istringstream	broken{ "xxxlog" };
+		xxx::log::decode(broken, oss);
+	}
+	catch(std::invalid_argument const&)
+	{
+		std::cout << "expected exception occurred" << std::endl;
+	}
+}
+
+void
+test_batch_logger()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	std::filesystem::path const	path{ "test_batch.log" };
+	std::filesystem::remove(path);
+
+	xxx::log::add_logger("batch", xxx::log::level_t::Info, path, "", false);
+	auto&	logger	= xxx::log::logger("batch");
+	logger.set_batch(4096u, std::chrono::milliseconds{ 50 });
+
+	std::vector<std::thread>	threads;
+	for(int t{}; t < 4; ++t)
+	{
+		threads.emplace_back([&logger, t]()
+		{
+			for(int n{}; n < 1000; ++n)
+			{
+				logger.info("thread:", t, " count:", n);
+			}
+		});
+	}
+	for(auto& thread : threads)
+	{
+		thread.join();
+	}
+	logger.info("thread:", 4, " count:", 0);
+	std::this_thread::sleep_for(std::chrono::milliseconds{ 500 });	// without flush.
+	std::cout << count_lines(path) << std::endl;
+	xxx::log::remove_logger("batch");
+
+	// Lines are whole and in order within each thread.
+	std::ifstream	ifs{ path };
+	int				next[5]{};
+	bool			ordered{ true };
+	for(std::string line; std::getline(ifs, line); )
+	{
+		auto const	t{ line.find("[I]thread:") };
+		auto const	c{ line.find(" count:") };
+		if(t == std::string::npos || c == std::string::npos)
+		{
+			ordered	= false;
+			continue;
+		}
+		auto const	thread{ std::stoi(line.substr(t + 10u, c - t - 10u)) };
+		ordered	= ordered && std::stoi(line.substr(c + 7u)) == next[thread]++;
+	}
+	std::cout << ordered << std::endl;
+}
+
+void
+test_profile()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	std::filesystem::path const	path{ "test_profile.log" };
+	std::filesystem::remove(path);
+
+	xxx::log::add_logger("profile", xxx::log::level_t::Info, path, "", false);
+	auto&	logger	= xxx::log::logger("profile");
+	xxx::log::reset_profile();
+
+	auto const	scope{ [&logger]()
+	{
+		xxx::log::tracer_t	t(logger, xxx_logpos, "arg");	// Trace level is not logged.
+		std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+	} };
+
+	scope();	// not profiled.
+	logger.set_profiling(true);
+	std::vector<std::thread>	threads;
+	for(int t{}; t < 2; ++t)
+	{
+		threads.emplace_back([&scope]()
+		{
+			for(int n{}; n < 20; ++n)
+			{
+				scope();
+			}
+		});
+	}
+	for(auto& thread : threads)
+	{
+		thread.join();	// histograms of exited threads remain.
+	}
+	scope();
+
+	auto const	profiles{ xxx::log::profile() };
+	std::cout << profiles.size() << ' ' << profiles.front().count << ' ' << profiles.front().file << std::endl;
+	auto const&	p{ profiles.front() };
+	std::cout	<< (std::chrono::milliseconds{ 1 } <= p.p50) << (p.p50 <= p.p99) << (p.p99 <= p.p999) << (p.p999 <= p.max)
+				<< (p.count * std::chrono::milliseconds{ 1 } <= p.total) << std::endl;
+
+	xxx::log::dump_profile(logger, xxx::log::level_t::Info, xxx_logpos);
+	logger.flush();
+	std::cout << count_lines(path) << std::endl;
+	xxx::log::remove_logger("profile");
+
+	xxx::log::reset_profile();
+	std::cout << xxx::log::profile().size() << std::endl;
+}
+
+void
+test_json_logger()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	std::filesystem::path const	path{ "test_json.log" };
+	std::filesystem::remove(path);
+
+	xxx::log::add_logger("json", xxx::log::level_t::Info, path, "", false);
+	auto&	logger	= xxx::log::logger("json");
+	logger.info("text ", xxx::log::field("id", 42));
+	logger.set_format(xxx::log::format_t::Json);
+
+	std::map<std::string, int> const	object{ { "a", 1 }, { "b\"", 2 } };
+	std::map<int, std::string> const	keys{ { 1, "x" } };
+	logger.info(xxx_logpos, "user", xxx::log::field("id", 42), std::vector<int>{ 1, 2 }, object, keys, 1.5, true, 'c');
+	logger.info(xxx_logpos, "a long string with a \"quote\", a \\ and a \ttab\x01", std::set<std::string>{}, 1.0 / 0.0);
+	logger.info(xxx_logpos, std::string{ "message" });
+	logger.info("no position", xxx::log::field("flags", std::vector<bool>{ true }));
+	xxx::log::remove_logger("json");
+
+	std::ifstream	ifs{ path };
+	for(std::string line; std::getline(ifs, line); )
+	{
+		auto const	level{ line.find("\"level\"") };
+		std::cout << (level == std::string::npos ? line.substr(line.find('[')) : "{" + line.substr(level)) << std::endl;
+	}
+}
+
+void
+test_sink_logger()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	class memory_sink_t : public xxx::log::sink_t
+	{
+	public:
+		void	write(xxx::log::line_t const& line) override	{ std::lock_guard lock{ mutex_ }; lines_.emplace_back(line.message);	}
+		auto	lines() const	{ std::lock_guard lock{ mutex_ }; return lines_;	}
+	private:
+		mutable std::mutex			mutex_;
+		std::vector<std::string>	lines_;
+	};
+
+	std::filesystem::path const	path{ "test_sink.log" };
+	std::filesystem::remove(path);
+
+	xxx::log::add_logger("sink", xxx::log::level_t::Debug, path, "", false);
+	auto&	logger	= xxx::log::logger("sink");
+	logger.file_sink().set_level(xxx::log::level_t::Warn);
+
+	auto const	sync{ std::make_shared<memory_sink_t>() };
+	sync->set_filter([](xxx::log::line_t const& line) { return line.message.find("secret") == std::string_view::npos; });
+	auto const	async{ std::make_shared<memory_sink_t>() };
+	async->set_level(xxx::log::level_t::Info);
+	logger.add_sink(sync);
+	logger.add_sink(async, 16u);
+
+	logger.debug("debug");
+	logger.info("info");
+	logger.info("secret");
+	logger.warn("warn");
+	logger.remove_sink(async);		// writes the queued lines.
+	logger.err("error");
+	xxx::log::remove_logger("sink");
+
+	for(auto const& sink : { sync, async })
+	{
+		for(auto const& line : sink->lines())
+		{
+			std::cout << line << ' ';
+		}
+		std::cout << std::endl;
+	}
+	std::ifstream	ifs{ path };
+	for(std::string line; std::getline(ifs, line); )
+	{
+		std::cout << line.substr(line.find('[')) << std::endl;
+	}
+
+	// Sinks are attached and detached while other threads log.
+	xxx::log::add_logger("live", xxx::log::level_t::Info, "", "", false);
+	auto&	live	= xxx::log::logger("live");
+	std::atomic<bool>			stop{ false };
+	std::vector<std::thread>	threads;
+	for(int t{}; t < 2; ++t)
+	{
+		threads.emplace_back([&live, &stop]() { while( ! stop)	live.info("live"); });
+	}
+	std::size_t	written{};
+	for(int n{}; n < 50; ++n)
+	{
+		auto const	sink{ std::make_shared<memory_sink_t>() };
+		live.add_sink(sink, n % 2 == 0 ? 0u : 16u);
+		while(n % 2 == 0 && sink->lines().empty())
+		{
+			std::this_thread::yield();
+		}
+		live.remove_sink(sink);
+		written	+= sink->lines().size();
+	}
+	stop	= true;
+	for(auto& thread : threads)
+	{
+		thread.join();
+	}
+	xxx::log::remove_logger("live");
+	std::cout << (0u < written) << std::endl;
+}
+
+#if defined(xxx_posix) && ! defined(xxx_standard_cpp_only)
+
+//	Stand-in of syslog daemon.
+class syslogd_t
+{
+public:
+	std::string
+	receive()
+	{
+		char		buffer[1024];
+		auto const	size{ ::recv(socket_, buffer, sizeof(buffer), 0) };
+		if(size < 0)
+		{
+			return "(timeout)";
+		}
+		std::string const	datagram(buffer, static_cast<std::size_t>(size));
+		// strips the timestamp and pid.
+		auto const	pri{ datagram.find('>') + 1u };
+		auto const	ident{ pri + 16u };		// after 'Mmm dd hh:mm:ss '.
+		auto const	pid{ datagram.find('[', ident) };
+		auto const	message{ datagram.find("]: ", pid) + 3u };
+		pid_	= datagram.substr(pid + 1u, message - 3u - pid - 1u);
+		return datagram.substr(0u, pri) + datagram.substr(ident, pid - ident) + ": " + datagram.substr(datagram.find('[', message));
+	}
+	//	Gets the pid of the last received message.
+	std::string const&	pid() const noexcept	{ return pid_;	}
+
+	explicit syslogd_t(std::string const& path) : socket_{ ::socket(AF_UNIX, SOCK_DGRAM, 0) }, path_{ path }, pid_{}
+	{
+		::unlink(path_.c_str());
+		::sockaddr_un	address{};
+		address.sun_family	= AF_UNIX;
+		std::strncpy(address.sun_path, path_.c_str(), sizeof(address.sun_path) - 1u);
+		::bind(socket_, reinterpret_cast<::sockaddr const*>(&address), sizeof(address));
+		::timeval const	timeout{ 1, 0 };
+		::setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	}
+	~syslogd_t()
+	{
+		::close(socket_);
+		::unlink(path_.c_str());
+	}
+private:
+	int				socket_;
+	std::string		path_;
+	std::string		pid_;
+};
+
+void
+test_syslog_logger()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	std::string const	path{ "test_syslog.sock" };
+	auto	syslogd{ std::make_unique<syslogd_t>(path) };
+
+	xxx::log::add_logger("syslog", xxx::log::level_t::Info, "", "ident", false);
+	auto&	logger	= xxx::log::logger("syslog");
+	logger.set_syslog_option(xxx::log::syslog_option_t{ xxx::log::facility_t::Local0, path });
+
+	logger.info("first");
+	logger.err("second");
+	std::cout << syslogd->receive() << std::endl;
+	std::cout << syslogd->receive() << std::endl;
+
+	syslogd.reset();		// restarts the daemon.
+	syslogd	= std::make_unique<syslogd_t>(path);
+	logger.warn("reconnected");
+	std::cout << syslogd->receive() << std::endl;
+
+	if(auto const child{ ::fork() }; child == 0)
+	{
+		logger.warn("forked");		// a child process logs with its own pid.
+		std::_Exit(0);
+	}
+	else
+	{
+		::waitpid(child, nullptr, 0);
+		std::cout << syslogd->receive() << ' ' << (syslogd->pid() == std::to_string(child));
+		logger.warn("parent");
+		std::cout << ' ' << syslogd->receive() << ' ' << (syslogd->pid() == std::to_string(::getpid())) << std::endl;
+	}
+
+	logger.set_batch(4096u, std::chrono::milliseconds{ 50 });
+	for(int n{}; n < 3; ++n)
+	{
+		logger.info("batch:", n);
+	}
+	logger.flush();
+	for(int n{}; n < 3; ++n)
+	{
+		std::cout << syslogd->receive() << std::endl;
+	}
+	xxx::log::remove_logger("syslog");
+}
+
+#endif
+
+//	Text dumped by the flight recorder in a signal-safe way.
+std::string		recorder_s;
+
+void
+test_recorder_logger()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	std::filesystem::path const	path{ "test_recorder.log" };
+	std::filesystem::remove(path);
+
+	xxx::log::add_logger("recorder", xxx::log::level_t::Info, path, "", false);
+	auto&	logger	= xxx::log::logger("recorder");
+	logger.set_recorder(xxx::log::level_t::Trace);
+	std::cout << logger.enabled(xxx::log::level_t::Trace) << logger.enabled(xxx::log::level_t::Verbose) << std::endl;
+
+	logger.debug("debug");
+	logger.info("info");
+	std::thread{ [&logger]() { logger.trace("trace"); } }.join();
+	logger.verbose("verbose");
+	logger.flush();
+	std::cout << count_lines(path) << std::endl;
+
+	logger.oops("fatal");				// dumps the recorded lines before it.
+	logger.debug("after");
+	logger.dump_recorder();
+	logger.dump_recorder();				// dumps nothing.
+	std::thread{ [&logger]() { logger.trace("late"); } }.join();
+	logger.dump_recorder();				// dumps only the line recorded after the last dump.
+
+	xxx::log::dump_recorder([](char const* data, std::size_t size) noexcept { recorder_s.append(data, size); });
+	std::istringstream	iss{ recorder_s };
+	for(std::string line; std::getline(iss, line); )
+	{
+		std::cout << line.substr(line.find('[')) << ' ';
+	}
+	std::cout << std::endl;
+	xxx::log::remove_logger("recorder");
+
+	std::ifstream	ifs{ path };
+	for(std::string line; std::getline(ifs, line); )
+	{
+		std::cout << line.substr(line.find('[')) << std::endl;
+	}
+}
+
+void
+test_metrics_logger()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	class failing_sink_t : public xxx::log::sink_t
+	{
+	public:
+		char const*	name() const noexcept override	{ return "failing";	}
+		void	write(xxx::log::line_t const&) override		{ throw std::runtime_error("failing");	}
+	};
+
+	std::filesystem::path const	path{ "test_metrics.log" };
+	std::filesystem::remove(path);
+
+	xxx::log::add_logger("metrics", xxx::log::level_t::Debug, path, "", false);
+	auto&	logger	= xxx::log::logger("metrics");
+	logger.file_sink().set_level(xxx::log::level_t::Info);
+	logger.add_sink(std::make_shared<failing_sink_t>());
+
+	logger.debug("debug");
+	logger.info("info");
+	logger.warn("warn");
+	logger.warn("warn");
+	logger.verbose("verbose");		// disabled calls are not counted.
+
+	auto const	metrics{ logger.metrics() };
+	std::cout << metrics.records[static_cast<std::size_t>(xxx::log::level_t::Debug)] << metrics.records[static_cast<std::size_t>(xxx::log::level_t::Info)]
+		<< metrics.records[static_cast<std::size_t>(xxx::log::level_t::Warn)] << metrics.records[static_cast<std::size_t>(xxx::log::level_t::Verbose)] << std::endl;
+	for(auto const& sink : metrics.sinks)
+	{
+		std::cout << sink.name << ':' << sink.lines << ',' << sink.bytes << ',' << sink.filtered << ',' << sink.errors << ' ';
+	}
+	std::cout << std::endl;
+
+	auto const	all{ xxx::log::metrics() };
+	std::cout << std::count_if(std::begin(all), std::end(all), [](auto const& m) { return m.tag == "metrics"; }) << std::endl;
+
+	xxx::log::dump_metrics(logger, xxx::log::level_t::Info, xxx_logpos);
+	logger.flush();
+	std::ifstream	ifs{ path };
+	for(std::string line; std::getline(ifs, line); )
+	{
+		if(line.find("tag=metrics sink=file") != std::string::npos)
+		{
+			std::cout << line.substr(line.find("lines="), line.find(" p50=") - line.find("lines=")) << std::endl;
+		}
+	}
+	xxx::log::remove_logger("metrics");
+
+	xxx::log::add_logger("unwritable", xxx::log::level_t::Info, "no_such_dir/test_metrics.log", "", false);
+	auto&	unwritable	= xxx::log::logger("unwritable");
+	unwritable.info("info");
+	unwritable.info("info");
+	for(auto const& sink : unwritable.metrics().sinks)
+	{
+		if(sink.name == std::string_view{ "file" })
+		{
+			std::cout << sink.name << ':' << sink.lines << ',' << sink.bytes << ',' << sink.errors << std::endl;
+		}
+	}
+	xxx::log::remove_logger("unwritable");
+}
+
+//	Argument which counts its formatting.
+struct counted_t
+{
+	inline static std::atomic<int>	formatted_s{};
+	int		value;
+};
+
+std::ostream&
+operator <<(std::ostream& os, counted_t const& counted)
+{
+	++counted_t::formatted_s;
+	return os << counted.value;
+}
+
+void
+test_rate_limit_logger()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	std::filesystem::path const	path{ "test_rate_limit.log" };
+	std::filesystem::remove(path);
+
+	xxx::log::add_logger("rate_limit", xxx::log::level_t::Info, path, "", false);
+	auto&	logger	= xxx::log::logger("rate_limit");
+	logger.set_rate_limit(xxx::log::level_t::All, xxx::log::rate_limit_t{ 2u, std::chrono::hours{ 1 } });
+	logger.set_rate_limit(xxx::log::level_t::Info, xxx::log::rate_limit_t{});
+	logger.set_rate_limit(xxx::log::level_t::Warn, xxx::log::rate_limit_t{ 1u, std::chrono::milliseconds{ 20 } });
+	std::cout << logger.rate_limit(xxx::log::level_t::Error).burst << logger.rate_limit(xxx::log::level_t::Info).burst << std::endl;
+
+	for(int n{}; n < 10; ++n)
+	{
+		logger.err(xxx_logpos, "hot");
+		xxx_log(logger, xxx::log::level_t::Error, "counted:", counted_t{ n });		// suppressed before formatting.
+		logger.info(xxx_logpos, "info");
+	}
+	auto const	shared{ xxx_logpos };
+	for(int n{}; n < 3; ++n)
+	{
+		logger.log(xxx::log::level_t::Error, shared, "shared:err");		// limited apart from the other level.
+		logger.log(xxx::log::level_t::Warn, shared, "shared:warn");
+	}
+	logger.warn(xxx_logpos, "other");
+	for(int n{}; n < 2; ++n)
+	{
+		logger.warn(xxx_logpos, "refilled");
+		std::this_thread::sleep_for(std::chrono::milliseconds{ 100 });
+	}
+	logger.err("no position");
+	logger.err("no position");
+	logger.err("no position");
+	logger.flush();		// summarizes the suppressed lines.
+	std::cout << counted_t::formatted_s << ' ' << logger.metrics().suppressed << std::endl;
+	xxx::log::remove_logger("rate_limit");
+
+	std::ifstream	ifs{ path };
+	std::map<std::string, int>	lines;
+	for(std::string line; std::getline(ifs, line); )
+	{
+		auto const	pos{ line.find("} ") };
+		++lines[pos == std::string::npos ? line.substr(line.find('[')) : line.substr(pos + 2u)];
+	}
+	for(auto const& [line, n] : lines)
+	{
+		std::cout << n << ' ' << line << std::endl;
+	}
+
+	std::filesystem::path const	local_path{ "test_rate_limit_local.log" };
+	std::filesystem::remove(local_path);
+	{
+		xxx::log::logger_t	local{ xxx::log::level_t::Info, local_path, "", false };
+		std::cout << local.rate_limit(xxx::log::level_t::Error).burst << ' ';
+		local.set_rate_limit(xxx::log::level_t::Error, xxx::log::rate_limit_t{ 1u, std::chrono::hours{ 1 } });
+		for(int n{}; n < 3; ++n)
+		{
+			local.err(xxx_logpos, "hot");
+		}
+	}	// the destructor summarizes the suppressed lines.
+	std::ifstream	local_ifs{ local_path };
+	for(std::string line; std::getline(local_ifs, line); )
+	{
+		std::cout << line.substr(line.find("} ") + 2u) << ' ';
+	}
+	std::cout << std::endl;
+}
+
 void
 test_string()
 {
@@ -239,6 +1102,29 @@ test_string()
 		std::cout << (xxx::trim_left(a) == left_result) << std::endl;
 		std::cout << (xxx::trim_right(a) == rihgt_result) << std::endl;
 		std::cout << (xxx::trim(a) == result) << std::endl;
+
+		std::cout	<< (xxx::trim_left_view(a) == left_result) << (xxx::trim_right_view(a) == rihgt_result)
+					<< (xxx::trim_view(a) == result) << xxx::trim_view(" \t\r\n").empty()
+					<< (xxx::trim_view(result).data() == result.data()) << std::endl;
+	}
+
+	{
+		auto const	print{ [](auto const& range) {
+			for (auto const field : range)	std::cout << '[' << field << ']';
+			std::cout << std::endl;
+		} };
+		print(xxx::split("a,,b,", ','));
+		print(xxx::split("a,,b,", ',', xxx::empty_fields_t::Skip));
+		print(xxx::split("a::b:c::", "::"));
+		print(xxx::split("a;b,,c", xxx::any_of_t{ ",;" }));
+		print(xxx::tokenize("  alpha\tbeta \r\n gamma "));
+		print(xxx::split("", ','));
+		try {
+			xxx::split("a", "");
+		} catch (std::invalid_argument const&)
+		{
+			std::cout << "expected exception occurred" << std::endl;
+		}
 	}
 
 	{
@@ -262,6 +1148,31 @@ test_string()
 		std::cout << xxx::lexical_cast<int>("255") << std::endl;
 		std::cout << xxx::lexical_cast<double>("1.234e2") << std::endl;
 	}
+
+	{
+		std::cout	<< xxx::lexical_cast<int>(" +42") << ' ' << xxx::lexical_cast<long long>(std::string{ "-9000000000" }) << ' '
+					<< xxx::lexical_cast<unsigned>("12abc") << ' ' << xxx::lexical_cast<float>("\t0.5") << ' '
+					<< xxx::lexical_cast<char>("x") << ' ' << xxx::lexical_cast<std::string>(" s ") << std::endl;
+		std::cout	<< xxx::try_lexical_cast<int>("x").has_value() << xxx::try_lexical_cast<unsigned>("-1").has_value()
+					<< xxx::try_lexical_cast<short>("70000").has_value() << xxx::try_lexical_cast<int>("+-1").has_value()
+					<< xxx::try_lexical_cast<bool>(" true").value_or(false) << std::endl;
+
+		for (auto const v : xxx::lexical_cast_list<int>(" 1, -2 ,3 "))	std::cout << v << ' ';
+		for (auto const v : xxx::lexical_cast_list<double>("1.5;2", ';'))	std::cout << v << ' ';
+		std::cout << xxx::lexical_cast_list<int>("").size() << std::endl;
+		try {
+			xxx::lexical_cast_list<int>("1,,3");
+		} catch (std::invalid_argument const&)
+		{
+			std::cout << "expected exception occurred" << std::endl;
+		}
+		try {
+			xxx::lexical_cast_list<int>("1,2x");
+		} catch (std::invalid_argument const&)
+		{
+			std::cout << "expected exception occurred" << std::endl;
+		}
+	}
 }
 
 int
@@ -272,5 +1183,22 @@ main()
 	test_exception_handling();
 	test_finally();
 	test_logger();
+	test_async_logger();
+	test_file_logger();
+	test_logger_registry();
+	test_logger_allocation();
+	test_logger_level();
+	test_logger_clock();
+	test_binary_logger();
+	test_batch_logger();
+	test_profile();
+	test_json_logger();
+	test_sink_logger();
+#if defined(xxx_posix) && ! defined(xxx_standard_cpp_only)
+	test_syslog_logger();
+#endif
+	test_recorder_logger();
+	test_metrics_logger();
+	test_rate_limit_logger();
 	test_string();
 }
@@ -0,0 +1,305 @@
+///	@file
+///	@brief		Test of UNICODE.
+///	@details	It compares the vectorized kernels with the scalar ones.
+///	@pre		ISO/IEC 14882:2020
+///	@author		Mura
+///	@copyright	(C) 2018-, Mura. All rights reserved.
+
+#include <xxx/uc.hxx>
+
+#include <stdexcept>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <optional>
+#include <random>
+#include <tuple>
+#include <iterator>
+#include <algorithm>
+
+//	Gets the result of conversion, or nullopt if it throws.
+template<typename F>
+auto
+try_convert(F const& f) -> std::optional<decltype(f())>
+{
+	try
+	{
+		return f();
+	}
+	catch(std::invalid_argument const&)
+	{
+		return std::nullopt;
+	}
+}
+
+//	Makes random strings around block boundaries including invalid ones.
+std::tuple<std::vector<std::u8string>, std::vector<std::u16string>, std::vector<std::u32string>>
+make_inputs()
+{
+	namespace uc	= xxx::uc;
+
+	std::mt19937					random{ 12345u };
+	std::vector<std::u8string>		u8s;
+	std::vector<std::u16string>		u16s;
+	std::vector<std::u32string>		u32s;
+	for(char8_t const* broken : { u8"\xC0\x80", u8"\xC1\xBF", u8"\xE0\x80\x80", u8"\xE0\x9F\xBF", u8"\xED\xA0\x80", u8"\xED\xBF\xBF",
+		u8"\xF0\x8F\xBF\xBF", u8"\xF4\x90\x80\x80", u8"\xF5\x80\x80\x80", u8"\xF8\x88\x80\x80\x80", u8"\xFF", u8"\x80", u8"\xE3\x81", u8"\xF0\x9D\x84" })
+	{
+		for(std::size_t offset{}; offset < 70u; ++offset)
+		{
+			u8s.push_back(std::u8string(offset, u8'a') + broken + std::u8string(random() % 40u, u8'b'));
+			u8s.push_back(std::u8string(offset, u8'a') + broken);
+		}
+	}
+	for(int n{}; n < 3000; ++n)
+	{
+		std::u32string	str;
+		for(auto size{ random() % 200u }; str.size() < size; )
+		{
+			switch(random() % 5u)
+			{
+			case 0u:	str.append(random() % 70u, static_cast<char32_t>(U' ' + random() % 0x5Fu));	break;
+			case 1u:	str.push_back(static_cast<char32_t>(0x80u + random() % 0x780u));				break;
+			case 2u:	str.push_back(static_cast<char32_t>(0x800u + random() % 0xD000u));				break;
+			case 3u:	str.push_back(static_cast<char32_t>(0xE000u + random() % 0x2000u));				break;
+			default:	str.push_back(static_cast<char32_t>(0x10000u + random() % 0x100000u));			break;
+			}
+		}
+		auto	valid8{ uc::to_u8string(str) };
+		auto	valid16{ uc::to_u16string(str) };
+		u32s.push_back(str);
+		u8s.push_back(valid8);
+		u16s.push_back(valid16);
+		if( ! str.empty())
+		{
+			// Broken by a random code unit.
+			str[random() % str.size()]			= static_cast<char32_t>(random() % 2u == 0u ? 0xD800u + random() % 0x800u : 0x110000u + random() % 0x1000u);
+			valid8[random() % valid8.size()]	= static_cast<char8_t>(random());
+			valid16[random() % valid16.size()]	= static_cast<char16_t>(0xD800u + random() % 0x800u);
+			u32s.push_back(str);
+			u8s.push_back(valid8);
+			u8s.push_back(valid8.substr(0u, random() % valid8.size()));
+			u16s.push_back(valid16);
+		}
+	}
+
+	return { u8s, u16s, u32s };
+}
+
+void
+test_uc()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	namespace uc	= xxx::uc;
+
+	// Encoded by the compiler.
+	std::u8string const		u8{ u8"ASCII \u00E9\u20AC\U0001D11E \u3042\u3044\u3046 0123456789abcdef0123456789abcdef\U0010FFFF" };
+	std::u16string const	u16{ u"ASCII \u00E9\u20AC\U0001D11E \u3042\u3044\u3046 0123456789abcdef0123456789abcdef\U0010FFFF" };
+	std::u32string const	u32{ U"ASCII \u00E9\u20AC\U0001D11E \u3042\u3044\u3046 0123456789abcdef0123456789abcdef\U0010FFFF" };
+	std::cout	<< (uc::to_u32string(u8) == u32) << (uc::to_u32string(u16) == u32)
+				<< (uc::to_u16string(u8) == u16) << (uc::to_u16string(u32) == u16)
+				<< (uc::to_u8string(u16) == u8) << (uc::to_u8string(u32) == u8) << std::endl;
+
+	auto const	inputs{ make_inputs() };
+	auto const&	u8s{ std::get<0>(inputs) };
+	auto const&	u16s{ std::get<1>(inputs) };
+	auto const&	u32s{ std::get<2>(inputs) };
+
+	auto const	convert{ [&]()
+	{
+		std::vector<std::optional<std::u32string>>	u32r;
+		std::vector<std::optional<std::u16string>>	u16r;
+		std::vector<std::optional<std::u8string>>	u8r;
+		std::vector<bool>							valid;
+		for(auto const& str : u8s)
+		{
+			valid.push_back(uc::is_valid(str));
+			u32r.push_back(try_convert([&str]() { return uc::to_u32string(str); }));
+			u16r.push_back(try_convert([&str]() { return uc::to_u16string(str); }));
+		}
+		for(auto const& str : u16s)
+		{
+			u32r.push_back(try_convert([&str]() { return uc::to_u32string(str); }));
+			u8r.push_back(try_convert([&str]() { return uc::to_u8string(str); }));
+		}
+		for(auto const& str : u32s)
+		{
+			u16r.push_back(try_convert([&str]() { return uc::to_u16string(str); }));
+			u8r.push_back(try_convert([&str]() { return uc::to_u8string(str); }));
+		}
+		return std::tuple{ u32r, u16r, u8r, valid };
+	} };
+
+	auto const	best{ uc::supported_simd() };
+	uc::set_simd(uc::simd_t::Scalar);
+	auto const	expected{ convert() };
+	bool		same{ true };
+	for(auto const simd : { uc::simd_t::SSE2, uc::simd_t::AVX2 })
+	{
+		if(static_cast<int>(simd) <= static_cast<int>(best))
+		{
+			uc::set_simd(simd);
+			same	= same && uc::simd() == simd && convert() == expected;
+		}
+	}
+	uc::set_simd(best);
+
+	// Valid strings round trip.
+	bool	round{ true };
+	for(auto const& str : u32s)
+	{
+		if(auto const u8{ try_convert([&str]() { return uc::to_u8string(str); }) })
+		{
+			round	= round && uc::to_u32string(*u8) == str && uc::to_u32string(uc::to_u16string(*u8)) == str;
+		}
+	}
+	std::cout << same << round << std::endl;
+}
+
+//	Transcodes in random chunks into a small buffer.
+template<typename From, typename To>
+std::optional<std::basic_string<To>>
+transcode(std::basic_string<From> const& input, xxx::uc::error_policy_t policy, std::mt19937& random)
+{
+	xxx::uc::transcoder_t<From, To>	transcoder{ policy };
+	std::basic_string<To>			output;
+	To								buffer[xxx::uc::transcoder_t<From, To>::max_units + 4u];
+	try
+	{
+		for(std::size_t n{}; n < input.size(); )
+		{
+			auto const	chunk{ std::basic_string_view<From>{ input }.substr(n, 1u + random() % 40u) };
+			for(std::size_t c{}; c < chunk.size(); )
+			{
+				auto const	size{ xxx::uc::transcoder_t<From, To>::max_units + random() % 5u };
+				auto const	[consumed, produced]{ transcoder.convert(chunk.substr(c), buffer, size) };
+				output.append(buffer, produced);
+				c	+= consumed;
+			}
+			n	+= chunk.size();
+		}
+		transcoder.finish(std::back_inserter(output));
+	}
+	catch(std::invalid_argument const&)
+	{
+		return std::nullopt;
+	}
+	return output;
+}
+
+//	Transcodes in random chunks into a small buffer, and continues after each invalid sequence.
+//	@return		Output and the number of invalid sequences.
+template<typename From, typename To>
+std::tuple<std::basic_string<To>, std::size_t>
+transcode_resuming(std::basic_string<From> const& input, std::mt19937& random)
+{
+	xxx::uc::transcoder_t<From, To>	transcoder{ xxx::uc::error_policy_t::Throw };
+	std::basic_string<To>			output;
+	std::size_t						errors{};
+	To								buffer[xxx::uc::transcoder_t<From, To>::max_units + 4u];
+	for(std::size_t n{}; n < input.size(); )
+	{
+		auto const	chunk{ std::basic_string_view<From>{ input }.substr(n, 1u + random() % 40u) };
+		for(std::size_t c{}; c < chunk.size(); )
+		{
+			auto const	size{ xxx::uc::transcoder_t<From, To>::max_units + random() % 5u };
+			try
+			{
+				auto const	[consumed, produced]{ transcoder.convert(chunk.substr(c), buffer, size) };
+				output.append(buffer, produced);
+				c	+= consumed;
+			}
+			catch(xxx::uc::transcode_error_t const& e)
+			{
+				output.append(buffer, e.produced());
+				c	+= e.consumed();
+				if(input.size() < ++errors)
+				{
+					return { output, errors };		// it does not make progress.
+				}
+			}
+		}
+		n	+= chunk.size();
+	}
+	try
+	{
+		transcoder.finish(std::back_inserter(output));
+	}
+	catch(xxx::uc::transcode_error_t const&)
+	{
+		++errors;
+	}
+	return { output, errors };
+}
+
+void
+test_transcoder()
+{
+	std::cout << "---[" << __func__ << "]---" << std::endl;
+
+	namespace uc	= xxx::uc;
+
+	std::mt19937	random{ 54321u };
+	auto const		inputs{ make_inputs() };
+	auto const&		u8s{ std::get<0>(inputs) };
+	auto const&		u16s{ std::get<1>(inputs) };
+	auto const&		u32s{ std::get<2>(inputs) };
+
+	// The same as the whole string conversion.
+	bool	same{ true };
+	for(auto const& str : u8s)
+	{
+		same	= same && transcode<char8_t, char32_t>(str, uc::error_policy_t::Throw, random) == try_convert([&str]() { return uc::to_u32string(str); });
+		same	= same && transcode<char8_t, char16_t>(str, uc::error_policy_t::Throw, random) == try_convert([&str]() { return uc::to_u16string(str); });
+	}
+	for(auto const& str : u16s)
+	{
+		same	= same && transcode<char16_t, char32_t>(str, uc::error_policy_t::Throw, random) == try_convert([&str]() { return uc::to_u32string(str); });
+		same	= same && transcode<char16_t, char8_t>(str, uc::error_policy_t::Throw, random) == try_convert([&str]() { return uc::to_u8string(str); });
+	}
+	for(auto const& str : u32s)
+	{
+		same	= same && transcode<char32_t, char16_t>(str, uc::error_policy_t::Throw, random) == try_convert([&str]() { return uc::to_u16string(str); });
+		same	= same && transcode<char32_t, char8_t>(str, uc::error_policy_t::Throw, random) == try_convert([&str]() { return uc::to_u8string(str); });
+	}
+
+	// Chunk boundaries do not change the results.
+	bool	stable{ true };
+	for(auto const& str : u8s)
+	{
+		for(auto const policy : { uc::error_policy_t::Replace, uc::error_policy_t::Skip })
+		{
+			uc::transcoder_t<char8_t, char32_t>	transcoder{ policy };
+			std::u32string						whole;
+			transcoder.finish(std::get<2>(transcoder.convert(str, std::back_inserter(whole))));
+			stable	= stable && transcode<char8_t, char32_t>(str, policy, random) == whole;
+		}
+	}
+	std::cout << same << stable << std::endl;
+
+	// Errors report the progress, and the transcoder continues after them as skipping.
+	bool	resumed{ true };
+	for(auto const& str : u8s)
+	{
+		auto const	[output, errors]{ transcode_resuming<char8_t, char16_t>(str, random) };
+		auto const	skipped{ *transcode<char8_t, char16_t>(str, uc::error_policy_t::Skip, random) };
+		auto const	replaced{ *transcode<char8_t, char16_t>(str, uc::error_policy_t::Replace, random) };
+		auto const	replacements{ std::count(replaced.begin(), replaced.end(), u'\uFFFD') - std::count(skipped.begin(), skipped.end(), u'\uFFFD') };
+		resumed	= resumed && output == skipped && errors == static_cast<std::size_t>(replacements);
+	}
+	std::cout << resumed << std::endl;
+
+	// Maximal subparts are replaced.
+	std::cout	<< (transcode<char8_t, char32_t>(u8"a\xE3\x81" u8"b\xED\xA0\x80\xC0\xAF\xF0\x9F\x98", uc::error_policy_t::Replace, random) == U"a\uFFFDb\uFFFD\uFFFD\uFFFD\uFFFD\uFFFD\uFFFD")
+				<< (transcode<char8_t, char16_t>(u8"a\xFF\xF0\x9F\x98\x80", uc::error_policy_t::Skip, random) == u"a\U0001F600")
+				<< (transcode<char16_t, char8_t>(std::u16string{ u'\xD800', u'x', u'\xDC00' }, uc::error_policy_t::Replace, random) == u8"\uFFFDx\uFFFD")
+				<< (transcode<char32_t, char8_t>(std::u32string{ U'x', char32_t{ 0x110000 } }, uc::error_policy_t::Replace, random) == u8"x\uFFFD") << std::endl;
+}
+
+int
+main()
+{
+	test_uc();
+	test_transcoder();
+}
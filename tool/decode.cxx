@@ -0,0 +1,42 @@
+///	@file
+///	@brief		Decoder of binary log files.
+///	@details	It writes the text of binary log files given as arguments, or the standard input, into the standard output.
+///	@pre		ISO/IEC 14882:2017
+///	@author		Mura
+///	@copyright	(C) 2018-, Mura. All rights reserved.
+
+#include <xxx/exceptions.hxx>
+#include <xxx/logger.hxx>
+
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+
+int
+main(int ac, char* av[])
+{
+	try
+	{
+		std::ios::sync_with_stdio(false);
+		if(ac < 2)
+		{
+			xxx::log::decode(std::cin, std::cout);
+		}
+		for(int n{ 1 }; n < ac; ++n)
+		{
+			std::ifstream	ifs{ av[n], std::ios::binary };
+			if( ! ifs)
+			{
+				throw std::runtime_error(std::string("cannot open ") + av[n]);
+			}
+			xxx::log::decode(ifs, std::cout);
+		}
+		std::cout.flush();
+		return 0;
+	}
+	catch(std::exception const& e)
+	{
+		xxx::dump_exception(std::cerr, e);
+	}
+	return 1;
+}
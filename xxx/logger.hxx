@@ -16,7 +16,14 @@
 #include <unordered_set>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <optional>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <array>
 
 #if defined(__cpp_lib_source_location) && 201907L <= __cpp_lib_source_location && __has_include(<source_location>)
 // uses standard source location
@@ -66,11 +73,27 @@ private:
 #define	xxx_logpos	::xxx::sl::source_location{__FILE__, __func__, __LINE__, 0}
 #endif
 
+///	@brief	Minimum severity of logging compiled in, as the value of level_t.
+///		Calls of less severe levels are removed at compile time,
+///		e.g., 5 (Info) removes debug, trace, and verbose logging.
+#if ! defined(xxx_min_log_level)
+#define	xxx_min_log_level	9
+#endif	// xxx_min_log_level
+
 #if defined(xxx_no_logging)
 #include <iosfwd>
 #else
 #include <sstream>
 #include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <tuple>
+#include <limits>
+#include <charconv>
+#include <type_traits>
+#include <algorithm>
+#include <cstring>
+#include <utility>
 #endif	// xxx_no_logging
 
 namespace xxx {
@@ -111,56 +134,495 @@ enum class level_t
 	All,		///< All (=Verbose).
 };
 
+///	@brief	Checks whether the logging level is compiled in or not.
+///	@param[in]		level		Logging level.
+///	@return		If the @p level is not removed by xxx_min_log_level, it returns true;
+///				otherwise, it returns false.
+///	@see		xxx_min_log_level
+inline constexpr bool
+is_compiled(level_t level) noexcept
+{
+#if defined(xxx_no_logging)
+	return static_cast<void>(level), false;
+#else	// xxx_no_logging
+	return static_cast<int>(level) <= xxx_min_log_level;
+#endif	// xxx_no_logging
+}
+
+///	@brief	Overflow policy of asynchronous logging.
+enum class overflow_t
+{
+	Block,		///< Blocks the caller until the queue has room.
+	DropNewest,	///< Drops the new record.
+	DropOldest,	///< Drops the oldest queued record.
+};
+
+///	@brief	Clock of timestamps.
+enum class clock_source_t
+{
+	Realtime,	///< System clock.
+	Monotonic,	///< Steady clock calibrated with the system clock periodically, which never goes backwards.
+};
+
+///	@brief	Format of log lines.
+enum class format_t
+{
+	Text,		///< Human-readable text with timestamp, level, and position of source.
+	Json,		///< JSON lines, which have typed arguments and fields.
+};
+
+///	@brief	Named argument.
+///		It is written as a field of the line in JSON format, and as "key=value" in text.
+///	@tparam		T		Type of value.
+///	@see		field
+template<typename T>
+struct field_t
+{
+	std::string_view	key;	///< Key.
+	T const&			value;	///< Value, which is referred until the logging returns.
+};
+
+///	@brief	Names an argument.
+///	@param[in]		key			Key.
+///	@param[in]		value		Value.
+///	@return		Named argument.
+template<typename T>
+inline field_t<T>
+field(std::string_view key, T const& value) noexcept
+{
+	return field_t<T>{ key, value };
+}
+
+///	@brief	Line of log passed to sinks.
+struct line_t
+{
+	level_t									level;		///< Logging level.
+	std::chrono::system_clock::time_point	time;		///< Time of logging.
+	std::string_view						message;	///< Message without prefix, or members of JSON line.
+	std::string_view						text;		///< Whole line without newline.
+	format_t								format;		///< Format of the line.
+};
+
+///	@brief	Output of log lines.
+///		Each sink has its own level and filter in addition to those of the logger.
+///	@see	logger_t::add_sink
+class sink_t
+{
+public:
+	///	@brief	Filter of lines.
+	using	filter_t	= std::function<bool(line_t const& line)>;
+
+	///	@brief	Writes a line.
+	///		A failed write should throw an exception, which is counted as an error in metrics.
+	///	@param[in]		line		Line.
+	virtual void	write(line_t const& line) = 0;
+	///	@brief	Writes lines gathered by batched writes.
+	///		By default, it writes each line.
+	///	@param[in]		lines		Lines in order.
+	virtual void	write_lines(std::vector<line_t> const& lines)	{ for(auto const& line : lines) write(line);	}
+	///	@brief	Flushes buffered lines.
+	virtual void	flush()	{}
+	///	@brief	Gets the name of the sink in metrics.
+	///	@return		Name of the sink.
+	virtual char const*	name() const noexcept	{ return "sink";	}
+
+	///	@brief	Sets level of the sink.
+	///	@param[in]		level		Level of the sink.
+	void	set_level(level_t level) noexcept				{ level_.store(level, std::memory_order_relaxed);	}
+	///	@brief	Sets filter of lines.
+	///		It should be set before other threads start logging through this sink.
+	///	@param[in]		filter		Filter, which returns true to write the line; empty means no filter.
+	void	set_filter(filter_t const& filter)				{ filter_	= filter;	}
+	///	@brief	Gets level of the sink.
+	///	@return		Level of the sink.
+	auto	level() const noexcept							{ return level_.load(std::memory_order_relaxed);	}
+	///	@brief	Checks whether the line is written into the sink or not.
+	///	@param[in]		line		Line.
+	///	@return		If the level and the filter accept it, it returns true; otherwise, it returns false.
+	bool
+	accepts(line_t const& line) const
+	{
+		return static_cast<int>(line.level) <= static_cast<int>(level()) && ( ! filter_ || filter_(line));
+	}
+public:
+	///	@brief	Constructor.
+	///	@param[in]		level		Level of the sink.
+	explicit sink_t(level_t level=level_t::All) : level_{ level }, filter_{} {}
+	///	@brief	Destructor.
+	virtual ~sink_t() = default;
+private:
+	sink_t(sink_t const&)						= delete;
+	sink_t const&	operator =(sink_t const&)	= delete;
+private:
+	std::atomic<level_t>	level_;		///< Level of the sink.
+	filter_t				filter_;	///< Filter of lines.
+};
+
+///	@brief	Options of log file.
+struct file_option_t
+{
+	std::size_t					buffer_size{ 64u * 1024u };	///< Size of the write buffer in bytes; zero means unbuffered.
+	std::chrono::milliseconds	flush_interval{ 1000 };		///< Maximum interval to keep data in the buffer; zero means no periodic flush.
+	std::uintmax_t				rotation_size{};			///< Size of file to rotate it in bytes; zero means no rotation by size.
+	std::chrono::seconds		rotation_period{};			///< Period to rotate the file; zero means no rotation by period.
+	std::size_t					retention{ 7u };			///< Number of rotated files to retain, e.g., 'name.1' to 'name.7'.
+};
+
+///	@brief	Facility of syslog, defined by RFC 5424.
+enum class facility_t : int
+{
+	Kern		= 0,
+	User		= 1,
+	Mail		= 2,
+	Daemon		= 3,
+	Auth		= 4,
+	Syslog		= 5,
+	Lpr			= 6,
+	News		= 7,
+	Uucp		= 8,
+	Cron		= 9,
+	Authpriv	= 10,
+	Ftp			= 11,
+	Local0		= 16,
+	Local1		= 17,
+	Local2		= 18,
+	Local3		= 19,
+	Local4		= 20,
+	Local5		= 21,
+	Local6		= 22,
+	Local7		= 23,
+};
+
+///	@brief	Options of syslog.
+///		They are used on POSIX only.
+struct syslog_option_t
+{
+	facility_t				facility{ facility_t::User };	///< Facility.
+	std::filesystem::path	path{ "/dev/log" };				///< Path of the local socket of syslog daemon.
+};
+
+///	@brief	Rate limit of lines per position of source.
+///		Each position has a token bucket, which holds up to @p burst lines and is refilled at @p burst lines per @p period.
+///	@see	logger_t::set_rate_limit
+struct rate_limit_t
+{
+	std::uint32_t				burst{};			///< Number of lines written at once; zero means no limit.
+	std::chrono::milliseconds	period{ 1000 };		///< Period to refill the bucket fully.
+};
+
+///	@brief	Profile of scopes traced at a position of source.
+///	@see	tracer_t, logger_t::set_profiling
+struct profile_t
+{
+	std::string					file;		///< File name of the position.
+	std::uint_least32_t			line{};		///< Line of the position.
+	std::string					function;	///< Function name of the position.
+	std::uint64_t				count{};	///< Number of measured scopes.
+	std::chrono::nanoseconds	total{};	///< Total elapsed time.
+	std::chrono::nanoseconds	p50{};		///< Median of elapsed time.
+	std::chrono::nanoseconds	p99{};		///< 99th percentile of elapsed time.
+	std::chrono::nanoseconds	p999{};		///< 99.9th percentile of elapsed time.
+	std::chrono::nanoseconds	max{};		///< Maximum elapsed time.
+};
+
+///	@brief	Metrics of a sink attached to a logger.
+///	@see	metrics_t
+struct sink_metrics_t
+{
+	std::string					name;			///< Name of the sink.
+	std::uint64_t				lines{};		///< Number of written lines.
+	std::uint64_t				bytes{};		///< Number of written bytes including newlines.
+	std::uint64_t				filtered{};		///< Number of lines filtered out by the level or the filter of the sink.
+	std::uint64_t				errors{};		///< Number of writes which failed.
+	std::uint64_t				dropped{};		///< Number of lines dropped by overflow of the queue of the sink.
+	std::uint64_t				samples{};		///< Number of writes whose latency is measured.
+	std::chrono::nanoseconds	p50{};			///< Median of latency of writes.
+	std::chrono::nanoseconds	p99{};			///< 99th percentile of latency of writes.
+	std::chrono::nanoseconds	max{};			///< Maximum latency of writes.
+};
+
+///	@brief	Metrics of a logger.
+///		Calls at disabled levels are not counted because they return before formatting.
+///	@see	logger_t::metrics, xxx::log::metrics
+struct metrics_t
+{
+	std::string						tag;			///< Tag of the logger, or empty if it is not in the registry.
+	std::array<std::uint64_t, 10u>	records{};		///< Number of records per level, indexed by level_t.
+	std::uint64_t					recorded{};		///< Number of records kept by the flight recorder instead of being written.
+	std::uint64_t					suppressed{};	///< Number of records suppressed by rate limits.
+	std::uint64_t					dropped{};		///< Number of records dropped by overflow of the asynchronous queue.
+	std::vector<sink_metrics_t>		sinks;			///< Metrics of sinks.
+};
+
 #if ! defined(xxx_no_logging)
 
 namespace impl {
 
-//	Dumps arguments.
+//	Buffer to format a message.
+//	It uses the inline storage for typical messages, and grows into heap only for long ones.
+class buffer_t : public std::streambuf
+{
+public:
+	//	Gets the formatted message.
+	//	@return		Formatted message.
+	std::string_view	view() const noexcept	{ return std::string_view(pbase(), static_cast<std::size_t>(pptr() - pbase()));	}
+	//	Gets the stream to write into the buffer.
+	//	@return		Stream.
+	std::ostream&		stream() noexcept		{ return os_;	}
+	//	Clears the buffer and the format state of the stream, e.g., changed by manipulators.
+	void
+	clear() noexcept
+	{
+		setp(pbase(), epptr());
+		os_.clear();
+		os_.flags(std::ios_base::dec | std::ios_base::skipws);
+		os_.width(0);
+		os_.precision(6);
+		os_.fill(' ');
+	}
+	//	Writes characters.
+	//	@param[in]		data		Characters.
+	//	@param[in]		size		Number of characters.
+	void
+	write(char const* data, std::size_t size)
+	{
+		if(static_cast<std::size_t>(epptr() - pptr()) < size)
+		{
+			grow_(size);
+		}
+		std::char_traits<char>::copy(pptr(), data, size);
+		pbump(static_cast<int>(size));
+	}
+	//	Overwrites characters already written.
+	//	@param[in]		offset		Offset to overwrite.
+	//	@param[in]		data		Characters.
+	//	@param[in]		size		Number of characters.
+	void
+	overwrite(std::size_t offset, char const* data, std::size_t size) noexcept
+	{
+		std::char_traits<char>::copy(pbase() + offset, data, size);
+	}
+	//	Discards characters after the size.
+	//	@param[in]		size		Size to keep.
+	void
+	truncate(std::size_t size) noexcept
+	{
+		setp(pbase(), epptr());
+		pbump(static_cast<int>(size));
+	}
+	//	Checks whether the buffer is in use or not.
+	//	@return		If the buffer is in use, it returns true; otherwise, it returns false.
+	bool				busy() const noexcept	{ return busy_;	}
+	//	Sets whether the buffer is in use or not.
+	//	@param[in]		busy		Whether the buffer is in use or not.
+	void				set_busy(bool busy) noexcept	{ busy_	= busy;	}
+
+	buffer_t() : storage_{}, heap_{}, busy_{ false }, os_{ this }
+	{
+		setp(storage_, storage_ + sizeof(storage_));
+	}
+protected:
+	int_type
+	overflow(int_type ch) override
+	{
+		if(traits_type::eq_int_type(ch, traits_type::eof()))
+		{
+			return traits_type::not_eof(ch);
+		}
+		char const	c{ traits_type::to_char_type(ch) };
+		write(&c, 1u);
+		return ch;
+	}
+	std::streamsize
+	xsputn(char const* data, std::streamsize size) override
+	{
+		write(data, static_cast<std::size_t>(size));
+		return size;
+	}
+private:
+	void
+	grow_(std::size_t size)
+	{
+		auto const	used{ static_cast<std::size_t>(pptr() - pbase()) };
+		std::string	heap(std::max(used + size, 2u * static_cast<std::size_t>(epptr() - pbase())), '\0');
+		std::char_traits<char>::copy(heap.data(), pbase(), used);
+		heap_.swap(heap);
+		setp(heap_.data(), heap_.data() + heap_.size());
+		pbump(static_cast<int>(used));
+	}
+private:
+	buffer_t(buffer_t const&)						= delete;
+	buffer_t const&		operator =(buffer_t const&)	= delete;
+private:
+	char			storage_[1024];	//< Inline storage.
+	std::string		heap_;			//< Storage for long messages.
+	bool			busy_;			//< Whether the buffer is in use or not.
+	std::ostream	os_;			//< Stream to write into the buffer.
+};
+
+//	Formats arguments into the buffer of the thread.
+//	@param[in]		format		Function object to format arguments into the stream.
+//	@param[in]		consume		Function object to consume the formatted message.
+template<typename F, typename C>
+inline void
+format_(F const& format, C const& consume)
+{
+	thread_local buffer_t	buffer_s;
+
+	if(buffer_s.busy())
+	{
+		// e.g., a manipulator logs something while formatting.
+		buffer_t	buffer;
+		format(buffer.stream());
+		consume(buffer.view());
+		return;
+	}
+
+	struct guard_t
+	{
+		buffer_t&	buffer;
+		explicit guard_t(buffer_t& b) noexcept : buffer{ b }	{ buffer.clear(); buffer.set_busy(true);	}
+		~guard_t()												{ buffer.set_busy(false);	}
+	}	guard{ buffer_s };
+
+	format(buffer_s.stream());
+	consume(buffer_s.view());
+}
+
+//	Writes characters into the stream.
 //	@param[in,out]	os		Output stream.
-//	@param[in]		head	Head of argruments.
-//	@param[in]		args	Other argument(s).
-template<typename T, typename... Args>
+//	@param[in]		data	Characters.
+//	@param[in]		size	Number of characters.
 inline void
-dump_(std::ostream& os, T const& head, Args... args)
+write_(std::ostream& os, char const* data, std::size_t size)
 {
-	os	<< head;
-	if constexpr (0 < sizeof...(Args))
+	if(auto const buffer{ dynamic_cast<buffer_t*>(os.rdbuf()) }; buffer != nullptr)
 	{
-		dump_(os, args...);
+		buffer->write(data, size);
+	}
+	else
+	{
+		os.write(data, static_cast<std::streamsize>(size));
+	}
+}
+
+//	Checks whether the stream has the default format, i.e., no manipulators have changed it.
+//	@param[in]		os		Output stream.
+//	@return		If the format is the default one, it returns true; otherwise, it returns false.
+inline bool
+plain_(std::ostream const& os) noexcept
+{
+	constexpr auto	formats{ std::ios_base::basefield | std::ios_base::floatfield | std::ios_base::boolalpha | std::ios_base::showbase
+							| std::ios_base::showpoint | std::ios_base::showpos | std::ios_base::uppercase };
+	return os.width() == 0 && os.precision() == 6 && (os.flags() & formats) == std::ios_base::dec;
+}
+
+template<typename T>						void	dump_(std::ostream& os, T const& value);
+template<typename T>						void	dump_(std::ostream& os, std::vector<T> const& value);
+template<typename T, typename V>			void	dump_(std::ostream& os, std::map<T, V> const& value);
+template<typename T>						void	dump_(std::ostream& os, std::set<T> const& value);
+template<typename T, typename V>			void	dump_(std::ostream& os, std::unordered_map<T, V> const& value);
+template<typename T>						void	dump_(std::ostream& os, std::unordered_set<T> const& value);
+template<typename T>						void	dump_(std::ostream& os, field_t<T> const& value);
+template<typename T, typename U, typename... Args>	void	dump_(std::ostream& os, T const& head, U const& next, Args const&... args);
+
+//	Dumps an argument.
+//	Numbers and strings are written without locale unless manipulators, e.g., std::hex or std::setw, change the format.
+//	@param[in,out]	os		Output stream.
+//	@param[in]		value	Argument.
+template<typename T>
+inline void
+dump_(std::ostream& os, T const& value)
+{
+	if constexpr (std::is_arithmetic_v<T> || std::is_convertible_v<T const&, std::string_view> || std::is_same_v<std::decay_t<T>, char const*> || std::is_same_v<std::decay_t<T>, char*>)
+	{
+		if( ! plain_(os))
+		{
+			if constexpr (std::is_arithmetic_v<T>)
+			{
+				os	<< value;
+			}
+			else if constexpr (std::is_pointer_v<T>)
+			{
+				os	<< (value == nullptr ? "" : value);
+			}
+			else
+			{
+				os	<< std::string_view{ value };
+			}
+			return;
+		}
+	}
+	if constexpr (std::is_same_v<T, bool>)
+	{
+		write_(os, value ? "1" : "0", 1u);
+	}
+	else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>)
+	{
+		auto const	ch{ static_cast<char>(value) };
+		write_(os, &ch, 1u);
+	}
+#if defined(__cpp_char8_t) && 201803 <= __cpp_char8_t
+	else if constexpr (std::is_same_v<T, char8_t>)
+	{
+		os	<< value;	// a character or its code unit in hexadecimal, not a number.
+	}
+#endif	// __cpp_char8_t
+	else if constexpr (std::is_integral_v<T>)
+	{
+		char		buffer[std::numeric_limits<T>::digits10 + 3];
+		auto const	result{ std::to_chars(std::begin(buffer), std::end(buffer), value) };
+		write_(os, buffer, static_cast<std::size_t>(result.ptr - buffer));
+	}
+	else if constexpr (std::is_floating_point_v<T>)
+	{
+		// The same as the default format of stream, i.e., "%g".
+		char		buffer[std::numeric_limits<T>::max_exponent10 + 32];
+		auto const	result{ std::to_chars(std::begin(buffer), std::end(buffer), value, std::chars_format::general, 6) };
+		write_(os, buffer, static_cast<std::size_t>(result.ptr - buffer));
+	}
+	else if constexpr (std::is_convertible_v<T const&, std::string_view> && ! std::is_pointer_v<T>)
+	{
+		std::string_view const	str{ value };
+		write_(os, str.data(), str.size());
+	}
+	else if constexpr (std::is_same_v<std::decay_t<T>, char const*> || std::is_same_v<std::decay_t<T>, char*>)
+	{
+		if(value != nullptr)
+		{
+			write_(os, value, std::char_traits<char>::length(value));
+		}
+	}
+	else
+	{
+		os	<< value;
 	}
 }
 //	Dumps vector arguments.
 //	@param[in,out]	os		Output stream.
-//	@param[in]		head	Head of argruments.
-//	@param[in]		args	Other argument(s).
-template <typename T, typename... Args>
+//	@param[in]		value	Argument.
+template <typename T>
 inline void
-dump_(std::ostream& os, std::vector<T> const& head, Args... args)
+dump_(std::ostream& os, std::vector<T> const& value)
 {
 	os << "[";
-	for (bool first {true}; auto const& arg : head)
+	for (bool first {true}; auto const& arg : value)
 	{
 		if (!first) os << ",";
 		first = false;
 		dump_(os, arg);
 	}
 	os << "]";
-	if constexpr (0 < sizeof...(Args))
-	{
-		dump_(os, args...);
-	}
 }
-
-//	Dumps vector arguments.
+//	Dumps map arguments.
 //	@param[in,out]	os		Output stream.
-//	@param[in]		head	Head of argruments.
-//	@param[in]		args	Other argument(s).
-template <typename T, typename V, typename... Args>
+//	@param[in]		value	Argument.
+template <typename T, typename V>
 inline void
-dump_(std::ostream& os, std::map<T,V> const& head, Args... args)
+dump_(std::ostream& os, std::map<T,V> const& value)
 {
 	os << "{";
-	for (bool first{ true }; auto const& arg : head)
+	for (bool first{ true }; auto const& arg : value)
 	{
 		if (!first) os << ",";
 		first = false;
@@ -169,42 +631,32 @@ dump_(std::ostream& os, std::map<T,V> const& head, Args... args)
 		dump_(os, arg.second);
 	}
 	os << "}";
-	if constexpr (0 < sizeof...(Args))
-	{
-		dump_(os, args...);
-	}
 }
-//	Dumps vector arguments.
+//	Dumps set arguments.
 //	@param[in,out]	os		Output stream.
-//	@param[in]		head	Head of argruments.
-//	@param[in]		args	Other argument(s).
-template <typename T, typename... Args>
+//	@param[in]		value	Argument.
+template <typename T>
 inline void
-dump_(std::ostream& os, std::set<T> const& head, Args... args)
+dump_(std::ostream& os, std::set<T> const& value)
 {
 	os << "{";
-	for (bool first{ true }; auto const& arg : head)
+	for (bool first{ true }; auto const& arg : value)
 	{
 		if (!first) os << ",";
 		first = false;
 		dump_(os, arg);
 	}
 	os << "}";
-	if constexpr (0 < sizeof...(Args))
-	{
-		dump_(os, args...);
-	}
 }
-//	Dumps vector arguments.
+//	Dumps unordered map arguments.
 //	@param[in,out]	os		Output stream.
-//	@param[in]		head	Head of argruments.
-//	@param[in]		args	Other argument(s).
-template <typename T, typename V, typename... Args>
+//	@param[in]		value	Argument.
+template <typename T, typename V>
 inline void
-dump_(std::ostream& os, std::unordered_map<T, V> const& head, Args... args)
+dump_(std::ostream& os, std::unordered_map<T, V> const& value)
 {
 	os << "{";
-	for (bool first{ true }; auto const& arg : head)
+	for (bool first{ true }; auto const& arg : value)
 	{
 		if (!first) os << ",";
 		first = false;
@@ -213,31 +665,46 @@ dump_(std::ostream& os, std::unordered_map<T, V> const& head, Args... args)
 		dump_(os, arg.second);
 	}
 	os << "}";
-	if constexpr (0 < sizeof...(Args))
-	{
-		dump_(os, args...);
-	}
 }
-//	Dumps vector arguments.
+//	Dumps unordered set arguments.
 //	@param[in,out]	os		Output stream.
-//	@param[in]		head	Head of argruments.
-//	@param[in]		args	Other argument(s).
-template <typename T, typename... Args>
+//	@param[in]		value	Argument.
+template <typename T>
 inline void
-dump_(std::ostream& os, std::unordered_set<T> const& head, Args... args)
+dump_(std::ostream& os, std::unordered_set<T> const& value)
 {
 	os << "{";
-	for (bool first{ true }; auto const& arg : head)
+	for (bool first{ true }; auto const& arg : value)
 	{
 		if (!first) os << ",";
 		first = false;
 		dump_(os, arg);
 	}
 	os << "}";
-	if constexpr (0 < sizeof...(Args))
-	{
-		dump_(os, args...);
-	}
+}
+//	Dumps arguments.
+//	@param[in,out]	os		Output stream.
+//	@param[in]		head	Head of argruments.
+//	@param[in]		next	Next argument.
+//	@param[in]		args	Other argument(s).
+template<typename T, typename U, typename... Args>
+inline void
+dump_(std::ostream& os, T const& head, U const& next, Args const&... args)
+{
+	dump_(os, head);
+	dump_(os, next, args...);
+}
+
+//	Dumps a named argument as "key=value".
+//	@param[in,out]	os		Output stream.
+//	@param[in]		value	Named argument.
+template<typename T>
+inline void
+dump_(std::ostream& os, field_t<T> const& value)
+{
+	write_(os, value.key.data(), value.key.size());
+	write_(os, "=", 1u);
+	dump_(os, value.value);
 }
 
 //	Dumps arguments with separation comma.
@@ -246,7 +713,7 @@ dump_(std::ostream& os, std::unordered_set<T> const& head, Args... args)
 //	@param[in]		args	Other argument(s).
 template <typename T, typename... Args>
 inline void
-enclose_(std::ostream& os, T const& head, Args... args)
+enclose_(std::ostream& os, T const& head, Args const&... args)
 {
 	dump_(os, head);
 	if constexpr (0 < sizeof...(args))
@@ -256,6 +723,448 @@ enclose_(std::ostream& os, T const& head, Args... args)
 	}
 }
 
+//	Arguments enclosed by parenthesis.
+//	It refers the arguments to dump them without a temporary string.
+template<typename... Args>
+struct enclosed_t
+{
+	std::tuple<Args const&...>	args;	//< Arguments.
+
+	//	Dumps enclosed arguments.
+	//	@param[in,out]	os		Output stream.
+	//	@param[in]		value	Enclosed arguments.
+	friend std::ostream&
+	operator <<(std::ostream& os, enclosed_t const& value)
+	{
+		os << '(';
+		if constexpr (0 < sizeof...(Args))
+		{
+			std::apply([&os](auto const&... args) { enclose_(os, args...); }, value.args);
+		}
+		os	<< ')';
+		return os;
+	}
+};
+
+//	Tags of binary records.
+namespace tag {
+
+constexpr char	Site		= 'S';	//< Definition of source location.
+constexpr char	Record		= 'R';	//< Record.
+constexpr char	Bool		= 'b';	//< Boolean.
+constexpr char	Char		= 'c';	//< Character.
+constexpr char	Signed		= 'i';	//< Signed integer as zigzag LEB128.
+constexpr char	Unsigned	= 'u';	//< Unsigned integer as LEB128.
+constexpr char	Float		= 'd';	//< Floating point number as double.
+constexpr char	String		= 's';	//< String.
+constexpr char	Vector		= 'v';	//< Vector.
+constexpr char	Map			= 'm';	//< Map.
+constexpr char	Set			= 't';	//< Set.
+constexpr char	Enclosed	= 'e';	//< Arguments enclosed by parenthesis.
+
+}	// namespace tag
+
+//	Writes an unsigned integer as LEB128.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		value	Value.
+inline void
+put_varint_(buffer_t& buffer, std::uint64_t value)
+{
+	char		bytes[10];
+	std::size_t	size{};
+	do
+	{
+		bytes[size]	= static_cast<char>(value & 0x7Fu);
+		value		>>= 7;
+		if(value != 0u)
+		{
+			bytes[size]	= static_cast<char>(bytes[size] | 0x80);
+		}
+		++size;
+	} while(value != 0u);
+	buffer.write(bytes, size);
+}
+//	Writes a fixed-size unsigned integer as little endian.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		value	Value.
+//	@param[in]		size	Size in bytes.
+inline void
+put_fixed_(buffer_t& buffer, std::uint64_t value, std::size_t size)
+{
+	char	bytes[8];
+	for(std::size_t n{}; n < size; ++n)
+	{
+		bytes[n]	= static_cast<char>((value >> (8u * n)) & 0xFFu);
+	}
+	buffer.write(bytes, size);
+}
+//	Writes a tag.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		tag		Tag.
+inline void		put_tag_(buffer_t& buffer, char tag)	{ buffer.write(&tag, 1u);	}
+//	Writes a string with its length.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		str		String.
+inline void
+put_string_(buffer_t& buffer, std::string_view str)
+{
+	put_fixed_(buffer, str.size(), 4u);
+	buffer.write(str.data(), str.size());
+}
+
+template<typename T>						void	encode_(buffer_t& buffer, T const& value);
+template<typename T>						void	encode_(buffer_t& buffer, std::vector<T> const& value);
+template<typename T, typename V>			void	encode_(buffer_t& buffer, std::map<T, V> const& value);
+template<typename T>						void	encode_(buffer_t& buffer, std::set<T> const& value);
+template<typename T, typename V>			void	encode_(buffer_t& buffer, std::unordered_map<T, V> const& value);
+template<typename T>						void	encode_(buffer_t& buffer, std::unordered_set<T> const& value);
+template<typename... Args>					void	encode_(buffer_t& buffer, enclosed_t<Args...> const& value);
+template<typename T, typename U, typename... Args>	void	encode_(buffer_t& buffer, T const& head, U const& next, Args const&... args);
+
+//	Encodes an argument formatted as text into a string.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		value	Argument.
+template<typename T>
+inline void
+encode_text_(buffer_t& buffer, T const& value)
+{
+	put_tag_(buffer, tag::String);
+	auto const	offset{ buffer.view().size() };
+	put_fixed_(buffer, 0u, 4u);
+	dump_(buffer.stream(), value);
+	auto const	size{ buffer.view().size() - offset - 4u };
+	char const	bytes[]{ static_cast<char>(size & 0xFFu), static_cast<char>((size >> 8) & 0xFFu), static_cast<char>((size >> 16) & 0xFFu), static_cast<char>((size >> 24) & 0xFFu) };
+	buffer.overwrite(offset, bytes, sizeof(bytes));
+}
+//	Encodes an argument into binary.
+//	Types without own encoding are formatted as strings.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		value	Argument.
+template<typename T>
+inline void
+encode_(buffer_t& buffer, T const& value)
+{
+	if constexpr (std::is_same_v<T, bool>)
+	{
+		put_tag_(buffer, tag::Bool);
+		put_fixed_(buffer, value ? 1u : 0u, 1u);
+	}
+	else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>)
+	{
+		put_tag_(buffer, tag::Char);
+		put_fixed_(buffer, static_cast<unsigned char>(value), 1u);
+	}
+#if defined(__cpp_char8_t) && 201803 <= __cpp_char8_t
+	else if constexpr (std::is_same_v<T, char8_t>)
+	{
+		encode_text_(buffer, value);	// decoded as the same text as dump_.
+	}
+#endif	// __cpp_char8_t
+	else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+	{
+		auto const	v{ static_cast<std::int64_t>(value) };
+		put_tag_(buffer, tag::Signed);
+		put_varint_(buffer, (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63));
+	}
+	else if constexpr (std::is_integral_v<T>)
+	{
+		put_tag_(buffer, tag::Unsigned);
+		put_varint_(buffer, static_cast<std::uint64_t>(value));
+	}
+	else if constexpr (std::is_floating_point_v<T>)
+	{
+		auto const		v{ static_cast<double>(value) };
+		std::uint64_t	bits;
+		std::memcpy(&bits, &v, sizeof(bits));
+		put_tag_(buffer, tag::Float);
+		put_fixed_(buffer, bits, 8u);
+	}
+	else if constexpr (std::is_convertible_v<T const&, std::string_view> && ! std::is_pointer_v<T>)
+	{
+		put_tag_(buffer, tag::String);
+		put_string_(buffer, std::string_view{ value });
+	}
+	else if constexpr (std::is_same_v<std::decay_t<T>, char const*> || std::is_same_v<std::decay_t<T>, char*>)
+	{
+		put_tag_(buffer, tag::String);
+		put_string_(buffer, value == nullptr ? std::string_view() : std::string_view(value));
+	}
+	else
+	{
+		encode_text_(buffer, value);
+	}
+}
+//	Encodes an argument of a record.
+//	Once manipulators, e.g., std::hex or std::setw, change the format of the stream,
+//	the arguments after them are encoded as text formatted by dump_, so that they are decoded as the same text.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		value	Argument.
+template<typename T>
+inline void
+encode_arg_(buffer_t& buffer, T const& value)
+{
+	if(plain_(buffer.stream()))
+	{
+		encode_(buffer, value);
+	}
+	else
+	{
+		encode_text_(buffer, value);
+	}
+}
+//	Encodes elements of a container.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		tag		Tag of the container.
+//	@param[in]		value	Container.
+template<typename C>
+inline void
+encode_elements_(buffer_t& buffer, char tag, C const& value)
+{
+	put_tag_(buffer, tag);
+	put_varint_(buffer, value.size());
+	for(auto const& arg : value)
+	{
+		encode_(buffer, arg);
+	}
+}
+//	Encodes key-value pairs of a container.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		value	Container.
+template<typename C>
+inline void
+encode_pairs_(buffer_t& buffer, C const& value)
+{
+	put_tag_(buffer, tag::Map);
+	put_varint_(buffer, value.size());
+	for(auto const& arg : value)
+	{
+		encode_(buffer, arg.first);
+		encode_(buffer, arg.second);
+	}
+}
+template<typename T>				inline void		encode_(buffer_t& buffer, std::vector<T> const& value)				{ encode_elements_(buffer, tag::Vector, value);	}
+template<typename T, typename V>	inline void		encode_(buffer_t& buffer, std::map<T, V> const& value)				{ encode_pairs_(buffer, value);	}
+template<typename T>				inline void		encode_(buffer_t& buffer, std::set<T> const& value)					{ encode_elements_(buffer, tag::Set, value);	}
+template<typename T, typename V>	inline void		encode_(buffer_t& buffer, std::unordered_map<T, V> const& value)	{ encode_pairs_(buffer, value);	}
+template<typename T>				inline void		encode_(buffer_t& buffer, std::unordered_set<T> const& value)		{ encode_elements_(buffer, tag::Set, value);	}
+//	Encodes enclosed arguments.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		value	Enclosed arguments.
+template<typename... Args>
+inline void
+encode_(buffer_t& buffer, enclosed_t<Args...> const& value)
+{
+	put_tag_(buffer, tag::Enclosed);
+	put_varint_(buffer, sizeof...(Args));
+	std::apply([&buffer](auto const&... args) { (encode_arg_(buffer, args), ...); }, value.args);
+}
+//	Encodes arguments.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		head	Head of argruments.
+//	@param[in]		next	Next argument.
+//	@param[in]		args	Other argument(s).
+template<typename T, typename U, typename... Args>
+inline void
+encode_(buffer_t& buffer, T const& head, U const& next, Args const&... args)
+{
+	encode_arg_(buffer, head);
+	encode_arg_(buffer, next);
+	(encode_arg_(buffer, args), ...);
+}
+
+//	Finds the first character to escape in JSON strings, i.e., control characters, '"', and '\\'.
+//	@param[in]		data	Characters.
+//	@param[in]		size	Number of characters.
+//	@return		Offset of the character, or @p size if not found.
+std::size_t		find_json_escape_(char const* data, std::size_t size) noexcept;
+//	Writes a JSON string with quotes.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		str		String.
+void			put_json_string_(buffer_t& buffer, std::string_view str);
+
+template<typename T>						void	json_(buffer_t& buffer, T const& value);
+template<typename T>						void	json_(buffer_t& buffer, std::vector<T> const& value);
+template<typename T, typename V>			void	json_(buffer_t& buffer, std::map<T, V> const& value);
+template<typename T>						void	json_(buffer_t& buffer, std::set<T> const& value);
+template<typename T, typename V>			void	json_(buffer_t& buffer, std::unordered_map<T, V> const& value);
+template<typename T>						void	json_(buffer_t& buffer, std::unordered_set<T> const& value);
+template<typename... Args>					void	json_(buffer_t& buffer, enclosed_t<Args...> const& value);
+
+//	Writes an argument formatted as text into a JSON string.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		value	Argument.
+template<typename T>
+inline void
+json_text_(buffer_t& buffer, T const& value)
+{
+	auto const	offset{ buffer.view().size() };
+	buffer.write("\"", 1u);
+	dump_(buffer.stream(), value);
+	auto const	text{ buffer.view().substr(offset + 1u) };
+	if(find_json_escape_(text.data(), text.size()) == text.size())
+	{
+		buffer.write("\"", 1u);
+		return;
+	}
+	std::string const	str{ text };
+	buffer.truncate(offset);
+	put_json_string_(buffer, str);
+}
+//	Writes an argument as a JSON value.
+//	Types without own representation are formatted as strings.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		value	Argument.
+template<typename T>
+inline void
+json_(buffer_t& buffer, T const& value)
+{
+	if constexpr (std::is_same_v<T, bool>)
+	{
+		value ? buffer.write("true", 4u) : buffer.write("false", 5u);
+	}
+	else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>)
+	{
+		auto const	ch{ static_cast<char>(value) };
+		put_json_string_(buffer, std::string_view(&ch, 1u));
+	}
+	else if constexpr (std::is_integral_v<T>)
+	{
+		char		digits[std::numeric_limits<T>::digits10 + 3];
+		auto const	result{ std::to_chars(std::begin(digits), std::end(digits), value) };
+		buffer.write(digits, static_cast<std::size_t>(result.ptr - digits));
+	}
+	else if constexpr (std::is_floating_point_v<T>)
+	{
+		if(value != value || value - value != value - value)
+		{
+			json_text_(buffer, value);	// NaN and infinity are not numbers of JSON.
+			return;
+		}
+		char		digits[std::numeric_limits<T>::max_exponent10 + 32];
+		auto const	result{ std::to_chars(std::begin(digits), std::end(digits), value) };
+		buffer.write(digits, static_cast<std::size_t>(result.ptr - digits));
+	}
+	else if constexpr (std::is_convertible_v<T const&, std::string_view> && ! std::is_pointer_v<T>)
+	{
+		put_json_string_(buffer, std::string_view{ value });
+	}
+	else if constexpr (std::is_same_v<std::decay_t<T>, char const*> || std::is_same_v<std::decay_t<T>, char*>)
+	{
+		put_json_string_(buffer, value == nullptr ? std::string_view() : std::string_view(value));
+	}
+	else
+	{
+		json_text_(buffer, value);
+	}
+}
+//	Writes elements of a container as a JSON array.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		value	Container.
+template<typename C>
+inline void
+json_elements_(buffer_t& buffer, C const& value)
+{
+	buffer.write("[", 1u);
+	bool	first{ true };
+	for(auto const& arg : value)
+	{
+		if( ! std::exchange(first, false))
+		{
+			buffer.write(",", 1u);
+		}
+		json_(buffer, arg);
+	}
+	buffer.write("]", 1u);
+}
+//	Writes key-value pairs of a container as a JSON object.
+//	Keys other than strings are formatted as strings.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		value	Container.
+template<typename C>
+inline void
+json_pairs_(buffer_t& buffer, C const& value)
+{
+	using key_t	= typename C::key_type;
+
+	buffer.write("{", 1u);
+	bool	first{ true };
+	for(auto const& arg : value)
+	{
+		if( ! std::exchange(first, false))
+		{
+			buffer.write(",", 1u);
+		}
+		if constexpr (std::is_convertible_v<key_t const&, std::string_view> || std::is_same_v<key_t, char const*> || std::is_same_v<key_t, char*>)
+		{
+			json_(buffer, arg.first);
+		}
+		else
+		{
+			json_text_(buffer, arg.first);
+		}
+		buffer.write(":", 1u);
+		json_(buffer, arg.second);
+	}
+	buffer.write("}", 1u);
+}
+template<typename T>				inline void		json_(buffer_t& buffer, std::vector<T> const& value)				{ json_elements_(buffer, value);	}
+template<typename T, typename V>	inline void		json_(buffer_t& buffer, std::map<T, V> const& value)				{ json_pairs_(buffer, value);	}
+template<typename T>				inline void		json_(buffer_t& buffer, std::set<T> const& value)					{ json_elements_(buffer, value);	}
+template<typename T, typename V>	inline void		json_(buffer_t& buffer, std::unordered_map<T, V> const& value)		{ json_pairs_(buffer, value);	}
+template<typename T>				inline void		json_(buffer_t& buffer, std::unordered_set<T> const& value)			{ json_elements_(buffer, value);	}
+//	Writes enclosed arguments as a JSON array.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		value	Enclosed arguments.
+template<typename... Args>
+inline void
+json_(buffer_t& buffer, enclosed_t<Args...> const& value)
+{
+	buffer.write("[", 1u);
+	std::apply([&buffer](auto const&... args)
+	{
+		[[maybe_unused]] bool	first{ true };
+		((std::exchange(first, false) ? void() : buffer.write(",", 1u), json_(buffer, args)), ...);
+	}, value.args);
+	buffer.write("]", 1u);
+}
+
+//	Whether the type is a named argument or not.
+template<typename T>	constexpr bool	is_field_v					= false;
+template<typename T>	constexpr bool	is_field_v<field_t<T>>		= true;
+
+//	Writes arguments as members of a JSON object, i.e., unnamed arguments as "args" and named arguments as fields.
+//	@param[in,out]	buffer	Buffer.
+//	@param[in]		args	Arguments.
+template<typename... Args>
+inline void
+json_args_(buffer_t& buffer, Args const&... args)
+{
+	buffer.write("\"args\":[", 8u);
+	[[maybe_unused]] bool	first{ true };
+	([&buffer, &first](auto const& arg)
+	{
+		if constexpr ( ! is_field_v<std::decay_t<decltype(arg)>>)
+		{
+			if( ! std::exchange(first, false))
+			{
+				buffer.write(",", 1u);
+			}
+			json_(buffer, arg);
+		}
+	}(args), ...);
+	buffer.write("]", 1u);
+	([&buffer](auto const& arg)
+	{
+		if constexpr (is_field_v<std::decay_t<decltype(arg)>>)
+		{
+			buffer.write(",", 1u);
+			put_json_string_(buffer, arg.key);
+			buffer.write(":", 1u);
+			json_(buffer, arg.value);
+		}
+	}(args), ...);
+}
+
 }	// namespace impl
 
 #endif	// xxx_no_logging
@@ -266,16 +1175,11 @@ enclose_(std::ostream& os, T const& head, Args... args)
 ///	@return		Arguments separated with comma and enclosed by parenthesis.
 template<typename... Args>
 inline std::string
-enclose([[maybe_unused]] Args... args)
+enclose([[maybe_unused]] Args const&... args)
 {
 #if !defined(xxx_no_logging)
 	std::ostringstream	oss;
-	oss << '(';
-	if constexpr (0 < sizeof...(args))
-	{
-		impl::enclose_(oss, args...);
-	}
-	oss	<< ')';
+	oss	<< impl::enclosed_t<Args...>{ std::tie(args...) };
 	return oss.str();
 #else	// xxx_no_logging
 	return std::string();
@@ -309,17 +1213,65 @@ public:
 	void	set_logger(std::string const&) {}
 	void	set_path(std::filesystem::path const&) {}
 	void	set_console(bool) {}
+	void	set_async(std::size_t, overflow_t=overflow_t::Block) {}
+	void	set_batch(std::size_t, std::chrono::milliseconds=std::chrono::milliseconds{ 100 }) {}
+	void	set_file_option(file_option_t const&) {}
+	void	set_syslog_option(syslog_option_t const&) {}
+	void	set_level(level_t) {}
+	void	set_clock(clock_source_t) {}
+	void	set_binary(bool) {}
+	void	set_profiling(bool) {}
+	void	set_recorder(level_t) {}
+	void	set_rate_limit(level_t, rate_limit_t const&) {}
+	void	set_format(format_t) {}
+	void	add_sink(std::shared_ptr<sink_t> const&, std::size_t=0u, overflow_t=overflow_t::Block) {}
+	void	remove_sink(std::shared_ptr<sink_t> const&) {}
+	void	dump_recorder() {}
+	auto	metrics()const	{ return metrics_t();	}
+	void	flush() {}
 
+	bool	enabled(level_t)const noexcept	{ return false;	}
+	auto	level()const noexcept	{ return level_t::Silent;	}
+	auto	clock()const noexcept	{ return clock_source_t::Realtime;	}
+	bool	binary()const noexcept	{ return false;	}
+	bool	profiling()const noexcept	{ return false;	}
+	auto	recorder()const noexcept	{ return level_t::Silent;	}
+	auto	rate_limit(level_t)const noexcept	{ return rate_limit_t();	}
+	auto	format()const noexcept	{ return format_t::Text;	}
+	sink_t&	console_sink() noexcept	{ return null_sink_;	}
+	sink_t&	file_sink() noexcept	{ return null_sink_;	}
+	sink_t&	external_sink() noexcept	{ return null_sink_;	}
 	auto	logger()const noexcept	{ return std::filesystem::path();	}
 	auto	path()const noexcept	{ return std::string();	}
 	auto	console()const noexcept	{ return false;	}
+	auto	file_option()const noexcept	{ return file_option_t();	}
+	auto	syslog_option()const noexcept	{ return syslog_option_t();	}
 public:
 	logger_t(level_t, std::filesystem::path const&, std::string const, bool) {}
 	logger_t() {}
+private:
+	struct null_sink_t : sink_t	{ void	write(line_t const&) override {}	};
+	inline static null_sink_t	null_sink_{};
 };
 
 #else	// xxx_no_logging
 
+namespace impl {
+
+struct position_t;
+enum class kind_t;
+class counters_t;
+class limiter_t;
+struct flight_ring_t;
+struct attached_sink_t;
+class worker_t;
+class batcher_t;
+class console_sink_t;
+class file_sink_t;
+class external_sink_t;
+
+}	// namespace impl
+
 ///	@brief	Logger.
 class logger_t
 {
@@ -331,23 +1283,46 @@ public:
 	///	@param[in]		args		More arguments to log
 	template<typename... Args>
 	void
-	log(level_t level, sl::source_location const& pos, Args... args)
+	log(level_t level, sl::source_location const& pos, Args const&... args)
 	{
-		std::ostringstream	oss;
-		impl::dump_(oss, args...);
-		log_(level, pos, oss.str().c_str());
+		if( ! enabled(level) || ! admits_(level, pos))
+		{
+			return;
+		}
+		if(binary())
+		{
+			impl::format_([&args...](std::ostream& os) { impl::encode_(static_cast<impl::buffer_t&>(*os.rdbuf()), args...); },
+				[this, level, &pos](std::string_view payload) { log_binary_(level, pos, payload); });
+			return;
+		}
+		if(format() == format_t::Json)
+		{
+			impl::format_([&args...](std::ostream& os) { impl::json_args_(static_cast<impl::buffer_t&>(*os.rdbuf()), args...); },
+				[this, level, &pos](std::string_view body) { log_json_(level, pos, body); });
+			return;
+		}
+		impl::format_([&args...](std::ostream& os) { impl::dump_(os, args...); },
+			[this, level, &pos](std::string_view message) { log_(level, pos, message); });
 	}
 	///	@overload
 	void
 	log(level_t level, sl::source_location const& pos, char const* message)
 	{
-		log_(level, pos, message);
+		if( ! enabled(level) || ! admits_(level, pos))
+		{
+			return;
+		}
+		log_(level, pos, message == nullptr ? std::string_view() : std::string_view(message));
 	}
 	///	@overload
 	void
 	log(level_t level, sl::source_location const& pos, std::string const& message)
 	{
-		log_(level, pos, message.c_str());
+		if( ! enabled(level) || ! admits_(level, pos))
+		{
+			return;
+		}
+		log_(level, pos, message);
 	}
 	///	@brief	Dumps log as fatal error.
 	///	@tparam			Args		arguments
@@ -356,9 +1331,12 @@ public:
 	///	@see			xxx_logpos
 	template<typename... Args>
 	void
-	oops(sl::source_location const& pos, Args... args)
+	oops(sl::source_location const& pos, Args const&... args)
 	{
-		log(level_t::Fatal, pos, args...);
+		if constexpr (is_compiled(level_t::Fatal))
+		{
+			log(level_t::Fatal, pos, args...);
+		}
 	}
 	///	@brief	Dumps log as normal error.
 	///	@tparam			Args		arguments
@@ -367,9 +1345,12 @@ public:
 	///	@see			xxx_logpos
 	template<typename... Args>
 	void
-	err(sl::source_location const& pos, Args... args)
+	err(sl::source_location const& pos, Args const&... args)
 	{
-		log(level_t::Error, pos, args...);
+		if constexpr (is_compiled(level_t::Error))
+		{
+			log(level_t::Error, pos, args...);
+		}
 	}
 	///	@brief	Dumps log as warning.
 	///	@tparam			Args		arguments
@@ -378,9 +1359,12 @@ public:
 	///	@see			xxx_logpos
 	template<typename... Args>
 	void
-	warn(sl::source_location const& pos, Args... args)
+	warn(sl::source_location const& pos, Args const&... args)
 	{
-		log(level_t::Warn, pos, args...);
+		if constexpr (is_compiled(level_t::Warn))
+		{
+			log(level_t::Warn, pos, args...);
+		}
 	}
 	///	@brief	Dumps log as notice.
 	///	@tparam			Args		arguments
@@ -389,9 +1373,12 @@ public:
 	///	@see			xxx_logpos
 	template<typename... Args>
 	void
-	notice(sl::source_location const& pos, Args... args)
+	notice(sl::source_location const& pos, Args const&... args)
 	{
-		log(level_t::Notice, pos, args...);
+		if constexpr (is_compiled(level_t::Notice))
+		{
+			log(level_t::Notice, pos, args...);
+		}
 	}
 	///	@brief	Dumps log as information.
 	///	@tparam			Args		arguments
@@ -400,9 +1387,12 @@ public:
 	///	@see			xxx_logpos
 	template<typename... Args>
 	void
-	info(sl::source_location const& pos, Args... args)
+	info(sl::source_location const& pos, Args const&... args)
 	{
-		log(level_t::Info, pos, args...);
+		if constexpr (is_compiled(level_t::Info))
+		{
+			log(level_t::Info, pos, args...);
+		}
 	}
 	///	@brief	Dumps log as debug info.
 	///	@tparam			Args		arguments
@@ -411,9 +1401,12 @@ public:
 	///	@see			xxx_logpos
 	template<typename... Args>
 	void
-	debug(sl::source_location const& pos, Args... args)
+	debug(sl::source_location const& pos, Args const&... args)
 	{
-		log(level_t::Debug, pos, args...);
+		if constexpr (is_compiled(level_t::Debug))
+		{
+			log(level_t::Debug, pos, args...);
+		}
 	}
 	///	@brief	Dumps log as trace.
 	///	@tparam			Args		arguments
@@ -422,9 +1415,12 @@ public:
 	///	@see			xxx_logpos
 	template<typename... Args>
 	void
-	trace(sl::source_location const& pos, Args... args)
+	trace(sl::source_location const& pos, Args const&... args)
 	{
-		log(level_t::Trace, pos, args...);
+		if constexpr (is_compiled(level_t::Trace))
+		{
+			log(level_t::Trace, pos, args...);
+		}
 	}
 	///	@brief	Dumps log as verbose.
 	///	@tparam			Args		arguments
@@ -433,9 +1429,12 @@ public:
 	///	@see			xxx_logpos
 	template<typename... Args>
 	void
-	verbose(sl::source_location const& pos, Args... args)
+	verbose(sl::source_location const& pos, Args const&... args)
 	{
-		log(level_t::Verbose, pos, args...);
+		if constexpr (is_compiled(level_t::Verbose))
+		{
+			log(level_t::Verbose, pos, args...);
+		}
 	}
 
 	///	@brief	Dumps log.
@@ -444,23 +1443,46 @@ public:
 	///	@param[in]		args		More arguments to log
 	template<typename... Args>
 	void
-	log(level_t level, Args... args)
+	log(level_t level, Args const&... args)
 	{
-		std::ostringstream	oss;
-		impl::dump_(oss, args...);
-		log_(level, std::nullopt, oss.str().c_str());
+		if( ! enabled(level))
+		{
+			return;
+		}
+		if(binary())
+		{
+			impl::format_([&args...](std::ostream& os) { impl::encode_(static_cast<impl::buffer_t&>(*os.rdbuf()), args...); },
+				[this, level](std::string_view payload) { log_binary_(level, std::nullopt, payload); });
+			return;
+		}
+		if(format() == format_t::Json)
+		{
+			impl::format_([&args...](std::ostream& os) { impl::json_args_(static_cast<impl::buffer_t&>(*os.rdbuf()), args...); },
+				[this, level](std::string_view body) { log_json_(level, std::nullopt, body); });
+			return;
+		}
+		impl::format_([&args...](std::ostream& os) { impl::dump_(os, args...); },
+			[this, level](std::string_view message) { log_(level, std::nullopt, message); });
 	}
 	///	@overload
 	void
 	log(level_t level, char const* message)
 	{
-		log_(level, std::nullopt, message);
+		if( ! enabled(level))
+		{
+			return;
+		}
+		log_(level, std::nullopt, message == nullptr ? std::string_view() : std::string_view(message));
 	}
 	///	@overload
 	void
 	log(level_t level, std::string const& message)
 	{
-		log_(level, std::nullopt, message.c_str());
+		if( ! enabled(level))
+		{
+			return;
+		}
+		log_(level, std::nullopt, message);
 	}
 	///	@brief	Dumps log as fatal error.
 	///	@tparam			Args		arguments
@@ -468,9 +1490,12 @@ public:
 	///	@see			xxx_logpos
 	template<typename... Args>
 	void
-	oops(Args... args)
+	oops(Args const&... args)
 	{
-		log(level_t::Fatal, args...);
+		if constexpr (is_compiled(level_t::Fatal))
+		{
+			log(level_t::Fatal, args...);
+		}
 	}
 	///	@brief	Dumps log as normal error.
 	///	@tparam			Args		arguments
@@ -478,9 +1503,12 @@ public:
 	///	@see			xxx_logpos
 	template<typename... Args>
 	void
-	err(Args... args)
+	err(Args const&... args)
 	{
-		log(level_t::Error, args...);
+		if constexpr (is_compiled(level_t::Error))
+		{
+			log(level_t::Error, args...);
+		}
 	}
 	///	@brief	Dumps log as warning.
 	///	@tparam			Args		arguments
@@ -488,9 +1516,12 @@ public:
 	///	@see			xxx_logpos
 	template<typename... Args>
 	void
-	warn(Args... args)
+	warn(Args const&... args)
 	{
-		log(level_t::Warn, args...);
+		if constexpr (is_compiled(level_t::Warn))
+		{
+			log(level_t::Warn, args...);
+		}
 	}
 	///	@brief	Dumps log as notice.
 	///	@tparam			Args		arguments
@@ -498,9 +1529,12 @@ public:
 	///	@see			xxx_logpos
 	template<typename... Args>
 	void
-	notice(Args... args)
+	notice(Args const&... args)
 	{
-		log(level_t::Notice, args...);
+		if constexpr (is_compiled(level_t::Notice))
+		{
+			log(level_t::Notice, args...);
+		}
 	}
 	///	@brief	Dumps log as information.
 	///	@tparam			Args		arguments
@@ -508,9 +1542,12 @@ public:
 	///	@see			xxx_logpos
 	template<typename... Args>
 	void
-	info(Args... args)
+	info(Args const&... args)
 	{
-		log(level_t::Info, args...);
+		if constexpr (is_compiled(level_t::Info))
+		{
+			log(level_t::Info, args...);
+		}
 	}
 	///	@brief	Dumps log as debug info.
 	///	@tparam			Args		arguments
@@ -518,9 +1555,12 @@ public:
 	///	@see			xxx_logpos
 	template<typename... Args>
 	void
-	debug(Args... args)
+	debug(Args const&... args)
 	{
-		log(level_t::Debug, args...);
+		if constexpr (is_compiled(level_t::Debug))
+		{
+			log(level_t::Debug, args...);
+		}
 	}
 	///	@brief	Dumps log as trace.
 	///	@tparam			Args		arguments
@@ -528,9 +1568,12 @@ public:
 	///	@see			xxx_logpos
 	template<typename... Args>
 	void
-	trace(Args... args)
+	trace(Args const&... args)
 	{
-		log(level_t::Trace, args...);
+		if constexpr (is_compiled(level_t::Trace))
+		{
+			log(level_t::Trace, args...);
+		}
 	}
 	///	@brief	Dumps log as verbose.
 	///	@tparam			Args		arguments
@@ -538,66 +1581,262 @@ public:
 	///	@see			xxx_logpos
 	template<typename... Args>
 	void
-	verbose(Args... args)
+	verbose(Args const&... args)
 	{
-		log(level_t::Verbose, args...);
+		if constexpr (is_compiled(level_t::Verbose))
+		{
+			log(level_t::Verbose, args...);
+		}
 	}
 public:
 	///	@brief	Sets the external logger name as the following:
 	///		- [xxx_win32]	dump to debugger (in debug mode)
 	///		- [xxx_posix]	dump to syslog
 	///	@param[in]		logger		Logger name
-	void	set_logger(std::string const& logger)		{ std::lock_guard	l{ mutex_ };	logger_ = logger; }
+	void	set_logger(std::string const& logger);
 	///	@brief	Sets log file.
+	///		The new file is opened before the current one is closed.
 	///	@param[in]		path		The path of log name.
-	void	set_path(std::filesystem::path const& path)	{ std::lock_guard	l{ mutex_ };	path_		= path;		}
+	void	set_path(std::filesystem::path const& path);
+	///	@brief	Sets options of log file.
+	///	@param[in]		option		Options of log file.
+	void	set_file_option(file_option_t const& option);
+	///	@brief	Sets options of syslog.
+	///		The connection to syslog daemon is opened again with the options.
+	///	@param[in]		option		Options of syslog.
+	void	set_syslog_option(syslog_option_t const& option);
 	///	@brief	Sets whether dump it to standard error or not.
 	///	@param[in]		on		Whether dump it to standart error or not..
 	void	set_console(bool on)						{ std::lock_guard	l{ mutex_ };	console_	= on;		}
 	///	@brief	Sets loggihng level.
 	///	@param[in]		level		Logger level.
-	void	set_level(level_t level)					{ std::lock_guard	l{ mutex_ };	level_	= level;	}
+	void	set_level(level_t level)					{ level_.store(level, std::memory_order_relaxed);	}
+	///	@brief	Sets clock of timestamps.
+	///	@param[in]		clock		Clock of timestamps.
+	void	set_clock(clock_source_t clock)				{ clock_.store(clock, std::memory_order_relaxed);	}
+	///	@brief	Sets asynchronous logging.
+	///		Records are queued into a bounded queue and written by a background thread.
+	///		It should be set before other threads start logging through this logger.
+	///	@param[in]		capacity	Capacity of the queue; zero means synchronous logging.
+	///	@param[in]		overflow	Policy when the queue is full.
+	void	set_async(std::size_t capacity, overflow_t overflow=overflow_t::Block);
+	///	@brief	Sets batched writes.
+	///		Each thread gathers formatted lines into its own buffer, and the buffer is written
+	///		into standard error and log file at once when it is full, an error is logged,
+	///		or the @p latency passes since its first line.
+	///		Lines are kept whole and in order within each thread.
+	///		It should be set before other threads start logging through this logger.
+	///	@param[in]		size		Size of buffer per thread in bytes; zero means writing each line.
+	///	@param[in]		latency		Maximum latency before a partial buffer is written.
+	void	set_batch(std::size_t size, std::chrono::milliseconds latency=std::chrono::milliseconds{ 100 });
+	///	@brief	Sets binary logging.
+	///		Arguments are written into the log file as binary records without formatting,
+	///		and the file is turned back into text by the decoder tool (see xxx::decode).
+	///		Records in binary mode are written only into the log file;
+	///		neither standard error nor the external logger receives them.
+	///	@param[in]		on		Whether log records are written as binary or not.
+	void	set_binary(bool on)							{ binary_.store(on, std::memory_order_relaxed);	}
+	///	@brief	Sets format of log lines.
+	///		In JSON format, each line is an object which has "time", "level", "file", "line", "function",
+	///		"args" as an array of unnamed arguments, and named arguments (see xxx::log::field) as its members.
+	///		Arguments are written as typed JSON values without formatting them as text.
+	///		Binary logging takes precedence over it.
+	///	@param[in]		format		Format of log lines.
+	void	set_format(format_t format)					{ format_.store(format, std::memory_order_relaxed);	}
+	///	@brief	Sets profiling of scopes traced by tracer_t.
+	///		The elapsed time of each scope is measured with a monotonic clock
+	///		even if the level of tracer_t is not enabled.
+	///	@param[in]		on		Whether scopes are profiled or not.
+	///	@see	xxx::log::profile
+	void	set_profiling(bool on)						{ profiling_.store(on, std::memory_order_relaxed);	}
+	///	@brief	Sets level of the flight recorder.
+	///		Lines enabled by it but not by the logger level are kept in a fixed-size memory ring per thread
+	///		instead of being written. They are written into the sinks only when they are dumped;
+	///		a fatal error dumps them before itself.
+	///	@param[in]		level		Level of the flight recorder; level_t::Silent means no recording.
+	///	@see	dump_recorder
+	void	set_recorder(level_t level)					{ recorder_.store(level, std::memory_order_relaxed);	}
+	///	@brief	Sets rate limit of lines per position of source at the level.
+	///		Lines over the limit are suppressed before their arguments are formatted,
+	///		and summarized as "last message repeated N times" before the next written line of the position
+	///		or at flush(). Lines without position of source are not limited.
+	///		Up to 1024 pairs of position and limited level are tracked per logger; lines of more positions are not limited.
+	///	@param[in]		level		Logging level; level_t::All sets it for all the levels.
+	///	@param[in]		limit		Rate limit.
+	void	set_rate_limit(level_t level, rate_limit_t const& limit);
+	///	@brief	Attaches a sink.
+	///		Lines are written into the sink after standard error, log file, and the external logger.
+	///		It can be called while other threads log through this logger.
+	///	@param[in]		sink		Sink.
+	///	@param[in]		capacity	Capacity of the queue of its own background writer; zero means writing in the caller.
+	///	@param[in]		overflow	Policy when the queue is full.
+	void	add_sink(std::shared_ptr<sink_t> const& sink, std::size_t capacity=0u, overflow_t overflow=overflow_t::Block);
+	///	@brief	Detaches a sink.
+	///		It waits for the lines being written into the sink by other threads,
+	///		and the queued lines of the sink are written before it returns.
+	///		A sink must not log through the logger which it is attached to.
+	///	@param[in]		sink		Sink.
+	void	remove_sink(std::shared_ptr<sink_t> const& sink);
+	///	@brief	Writes lines kept by the flight recorder into the sinks in order of time.
+	///		Lines already dumped are not written again, and lines recorded after it are written by the next dump
+	///		even if their timestamps are earlier than the dumped ones.
+	///	@see	set_recorder
+	void	dump_recorder();
+	///	@brief	Waits until the queued records are written, and flushes the buffers of sinks.
+	void	flush();
+	///	@brief	Gets metrics of this logger.
+	///		Counters are sharded per thread, and the latency of every eighth write per thread is measured.
+	///		A failed write of a sink is counted as an error instead of being thrown.
+	///	@return		Metrics, whose tag is empty.
+	///	@see	xxx::log::metrics
+	metrics_t	metrics()const;
 
+	///	@brief	Checks whether the logging level is enabled or not.
+	///		It is checked before the arguments are formatted.
+	///		Levels enabled only by the flight recorder are enabled as well.
+	///	@param[in]		level		Logging level.
+	///	@return		If the @p level is enabled, it returns true; otherwise, it returns false.
+	bool	enabled(level_t level)const noexcept
+	{
+		return is_compiled(level) && static_cast<int>(level) <= std::max(static_cast<int>(level_.load(std::memory_order_relaxed)), static_cast<int>(recorder_.load(std::memory_order_relaxed)));
+	}
+	///	@brief	Gets loggihng level.
+	///	@return		Logger level.
+	auto			level()const noexcept	{ return level_.load(std::memory_order_relaxed);	}
+	///	@brief	Gets clock of timestamps.
+	///	@return		Clock of timestamps.
+	auto			clock()const noexcept	{ return clock_.load(std::memory_order_relaxed);	}
+	///	@brief	Gets whether log records are written as binary or not.
+	///	@return		If binary logging is enabled, it returns true; otherwise, it returns false.
+	bool			binary()const noexcept	{ return binary_.load(std::memory_order_relaxed);	}
+	///	@brief	Gets whether scopes traced by tracer_t are profiled or not.
+	///	@return		If profiling is enabled, it returns true; otherwise, it returns false.
+	bool			profiling()const noexcept	{ return profiling_.load(std::memory_order_relaxed);	}
+	///	@brief	Gets level of the flight recorder.
+	///	@return		Level of the flight recorder.
+	auto			recorder()const noexcept	{ return recorder_.load(std::memory_order_relaxed);	}
+	///	@brief	Gets rate limit of lines per position of source at the level.
+	///	@param[in]		level		Logging level.
+	///	@return		Rate limit.
+	rate_limit_t	rate_limit(level_t level)const;
+	///	@brief	Gets format of log lines.
+	///	@return		Format of log lines.
+	auto			format()const noexcept	{ return format_.load(std::memory_order_relaxed);	}
 	///	@brief	Gets the external logger name.
 	///	@return		External logger name.
 	auto const&		logger()const noexcept	{ return logger_;	}
 	///	@brief	Gets the path of log file.
 	///	@return		The path of log file.
 	auto const&		path()const noexcept	{ return path_;		}
+	///	@brief	Gets options of log file.
+	///	@return		Options of log file.
+	auto const&		file_option()const noexcept	{ return file_option_;	}
+	///	@brief	Gets options of syslog.
+	///	@return		Options of syslog.
+	auto const&		syslog_option()const noexcept	{ return syslog_option_;	}
 	///	@brief	Gets whether dump it to standard error or not.
 	///	@return		If standard error is available, it returns true;
 	///				otherwise, it return false.
 	auto			console()const noexcept	{ return console_;	}
+	///	@brief	Gets the sink of standard error, e.g., to set its level.
+	///	@return		Sink of standard error.
+	sink_t&			console_sink() noexcept;
+	///	@brief	Gets the sink of log file, e.g., to set its level.
+	///		Binary records are written into it only if its level is enabled.
+	///	@return		Sink of log file.
+	sink_t&			file_sink() noexcept;
+	///	@brief	Gets the sink of the external logger, e.g., to set its level.
+	///	@return		Sink of the external logger.
+	sink_t&			external_sink() noexcept;
 public:
 	///	@brief	Constructor.
 	///	@param[in]		level		Logger level.
 	///	@param[in]		path		The path of log file.
 	///	@param[in]		logger		External logger name.
 	///	@param[in]		console		Whether dump it to standard error or not.
-	logger_t(level_t level, std::filesystem::path const& path, std::string const&logger, bool console) : level_{level}, path_{path}, logger_{logger}, console_{console}, mutex_{}, file_mutex_{}, console_mutex_{}
-	{}
+	logger_t(level_t level, std::filesystem::path const& path, std::string const&logger, bool console);
 	///	@brief	Constructor.
-	logger_t() : level_{level_t::Info}, path_{}, logger_{}, console_{true}, mutex_{}, file_mutex_{}, console_mutex_{}
-	{}
+	logger_t();
+	///	@brief	Destructor.
+	///		It writes the queued records before destruction.
+	~logger_t();
 private:
-	void	log_(level_t level, std::optional<sl::source_location> const& pos, char const* message);
+	bool	admits_(level_t level, sl::source_location const& pos)
+	{
+		return (limited_.load(std::memory_order_acquire) & (1u << static_cast<int>(level))) == 0u || admit_(level, pos);
+	}
+	bool	admit_(level_t level, sl::source_location const& pos);
+	void	summarize_();
+	void	log_(level_t level, std::optional<sl::source_location> const& pos, std::string_view message);
+	void	write_(level_t level, std::optional<sl::source_location> const& pos, std::chrono::system_clock::time_point const& time, std::string_view message, bool json=false);
+	void	write_(level_t level, impl::position_t const* position, std::chrono::system_clock::time_point const& time, std::string_view message, bool json);
+	void	log_json_(level_t level, std::optional<sl::source_location> const& pos, std::string_view body);
+	template<typename F>
+	void	for_each_sink_(F const& f);
+	void	log_binary_(level_t level, std::optional<sl::source_location> const& pos, std::string_view payload);
+	void	write_binary_(level_t level, std::optional<sl::source_location> const& pos, std::chrono::system_clock::time_point const& time, std::string_view payload);
+	void	write_binary_(level_t level, std::uint64_t site, std::chrono::system_clock::time_point const& time, std::string_view payload);
+	bool	record_(level_t level, std::optional<sl::source_location> const& pos, std::chrono::system_clock::time_point const& time, std::string_view message, impl::kind_t kind);
 private:
-	level_t					level_;		///< Logger level.
+	std::atomic<level_t>	level_;		///< Logger level.
+	std::atomic<clock_source_t>	clock_;	///< Clock of timestamps.
+	std::atomic<bool>		binary_;	///< Whether log records are written as binary or not.
+	std::atomic<bool>		profiling_;	///< Whether scopes are profiled or not.
+	std::atomic<level_t>	recorder_;	///< Level of the flight recorder.
+	std::atomic<format_t>	format_;	///< Format of log lines.
+	std::atomic<std::uint32_t>	limited_;	///< Bit set of levels which have rate limits.
 	std::filesystem::path	path_;		///< The path of log file.
 	std::string				logger_;	///< External logger name.
 	bool					console_;	///< Whether dump it to standard error or not.
-	std::mutex				mutex_;		///< Mutex.
-	std::mutex				file_mutex_;	///< Mutex.
-	std::mutex				console_mutex_;	///< Mutex.
+	mutable std::mutex		mutex_;		///< Mutex.
+	std::unordered_map<impl::flight_ring_t const*, std::uint64_t>	recorded_;	///< Number of read slots per ring of the flight recorder.
+	file_option_t			file_option_;	///< Options of log file.
+	syslog_option_t			syslog_option_;	///< Options of syslog.
+	std::unique_ptr<impl::console_sink_t>	console_sink_;	///< Sink of standard error.
+	std::unique_ptr<impl::file_sink_t>		file_sink_;		///< Sink of log file.
+	std::unique_ptr<impl::external_sink_t>	external_sink_;	///< Sink of the external logger.
+	std::vector<impl::attached_sink_t>		sinks_;			///< Attached sinks, their writers, and their counters.
+	std::atomic<std::size_t>				attached_;		///< Number of attached sinks, which is checked before locking.
+	mutable std::shared_mutex				sinks_mutex_;	///< Mutex of the attached sinks, which is shared while lines are written.
+	std::unique_ptr<impl::counters_t>		counters_;		///< Counters of metrics.
+	std::unique_ptr<impl::limiter_t>		limiter_;		///< States of rate limits per position of source, or nullptr before any limit is set.
+	std::unique_ptr<impl::worker_t>	worker_;	///< Background writer of asynchronous logging.
+	std::unique_ptr<impl::batcher_t>	batcher_;	///< Buffers of batched writes.
+private:
+	logger_t(logger_t const&)						= delete;
+	logger_t const&		operator =(logger_t const&)	= delete;
 };
 
 #endif	// xxx_no_logging
 
 #if defined(xxx_no_logging)
 
-inline void			add_logger(std::string const&, level_t, std::filesystem::path const&, std::string const&, bool) {}
+inline void			add_logger(std::string const&, level_t, std::filesystem::path const&, std::string const&, bool, std::size_t=0u, overflow_t=overflow_t::Block) {}
 inline void			remove_logger(std::string const&) {}
-inline logger_t		logger(std::string const&) { return logger_t();	}
+inline logger_t		logger(std::string_view) { return logger_t();	}
+
+class handle_t
+{
+public:
+	logger_t&	operator *() const noexcept	{ return logger_;	}
+	logger_t*	operator ->() const noexcept	{ return &logger_;	}
+	logger_t&	get() const noexcept			{ return logger_;	}
+private:
+	inline static logger_t	logger_{};
+};
+
+inline handle_t		handle(std::string_view) { return handle_t();	}
+
+inline void			decode(std::istream&, std::ostream&) {}
+
+inline std::vector<profile_t>	profile() { return {};	}
+inline void			reset_profile() {}
+inline void			dump_profile(logger_t&, level_t, sl::source_location const&) {}
+inline void			dump_recorder(void (*)(char const*, std::size_t) noexcept) noexcept {}
+
+inline std::vector<metrics_t>	metrics() { return {};	}
+inline void			dump_metrics(logger_t&, level_t, sl::source_location const&) {}
+inline void			set_metrics_dump(std::string const&, level_t, std::chrono::milliseconds) {}
 
 #else	// xxx_no_logging
 
@@ -607,14 +1846,101 @@ inline logger_t		logger(std::string const&) { return logger_t();	}
 ///	@param[in]		path		The path of log file.
 ///	@param[in]		logger		External logger name.
 ///	@param[in]		console		Whether dump it to standard error or not.
-void		add_logger(std::string const& tag, level_t level, std::filesystem::path const& path, std::string const& logger, bool console);
+///	@param[in]		capacity	Capacity of asynchronous queue; zero means synchronous logging.
+///	@param[in]		overflow	Policy when the asynchronous queue is full.
+void		add_logger(std::string const& tag, level_t level, std::filesystem::path const& path, std::string const& logger, bool console, std::size_t capacity=0u, overflow_t overflow=overflow_t::Block);
 ///	@brief	Removes existing logger.
+///		The queued records of the logger are written before removal.
+///		The logger itself is released after every thread observes the removal
+///		and every handle of it is released.
 ///	@param[in]		tag			Tag of logger to remove.
 void		remove_logger(std::string const& tag);
 ///	@brief	Gets the logger.
+///		It takes no lock unless loggers are added or removed after the last call in the thread.
 ///	@param[in]		tag			Tag of logger.
 ///	@return			Logger.
-logger_t&	logger(std::string const& tag);
+logger_t&	logger(std::string_view tag);
+
+///	@brief	Handle of logger.
+///		It keeps the logger alive so that it can be resolved once and cached.
+class handle_t
+{
+public:
+	///	@brief	Gets the logger.
+	///	@return		Logger.
+	logger_t&	operator *() const noexcept		{ return *logger_;	}
+	///	@brief	Gets the logger.
+	///	@return		Logger.
+	logger_t*	operator ->() const noexcept	{ return logger_.get();	}
+	///	@brief	Gets the logger.
+	///	@return		Logger.
+	logger_t&	get() const noexcept			{ return *logger_;	}
+public:
+	///	@brief	Constructor.
+	///	@param[in]		logger		Logger.
+	explicit handle_t(std::shared_ptr<logger_t> const& logger) : logger_{ logger } {}
+private:
+	std::shared_ptr<logger_t>	logger_;	///< Logger.
+};
+
+///	@brief	Gets the handle of logger.
+///	@param[in]		tag			Tag of logger.
+///	@return			Handle of logger.
+handle_t	handle(std::string_view tag);
+
+///	@brief	Decodes binary log records into text.
+///		The text is the same as the logger writes in text mode
+///		except that timestamps are rendered in the local time zone of the decoder.
+///	@param[in,out]	is			Input stream of binary log file.
+///	@param[out]		os			Output stream of text.
+///	@exception		std::invalid_argument	The input is not binary log records.
+void		decode(std::istream& is, std::ostream& os);
+
+///	@brief	Gets profiles of scopes traced with profiling loggers.
+///		Histograms recorded by each thread are merged per position of source.
+///		Percentiles are the upper bounds of histogram buckets, whose relative error is within about 3%.
+///	@return			Profiles ordered by the position of source.
+///	@see	logger_t::set_profiling
+std::vector<profile_t>	profile();
+///	@brief	Discards profiles measured so far.
+///		Scopes being measured concurrently may be kept.
+void		reset_profile();
+///	@brief	Dumps profiles into the logger, a line per position of source.
+///	@param[in]		logger		Logger to dump.
+///	@param[in]		level		Logging level.
+///	@param[in]		pos			Position of source to dump.
+void		dump_profile(logger_t& logger, level_t level, sl::source_location const& pos);
+
+///	@brief	Dumps lines kept by the flight recorders of all loggers, a thread after another.
+///		It is async-signal-safe, i.e., it neither allocates memory nor locks,
+///		so that it can be called in a signal handler, e.g., of SIGSEGV.
+///		Timestamps are seconds since the epoch, and binary records are not decoded.
+///	@param[in]		write		Function to write a chunk of text, which should be async-signal-safe as well, e.g., with ::write.
+///	@see	logger_t::set_recorder
+void		dump_recorder(void (*write)(char const* data, std::size_t size) noexcept) noexcept;
+
+///	@brief	Gets metrics of the loggers in the registry.
+///	@return			Metrics ordered by the tag of logger.
+///	@see	logger_t::metrics
+std::vector<metrics_t>	metrics();
+///	@brief	Dumps metrics of the loggers in the registry into the logger, a line per logger and sink.
+///	@param[in]		logger		Logger to dump.
+///	@param[in]		level		Logging level.
+///	@param[in]		pos			Position of source to dump.
+void		dump_metrics(logger_t& logger, level_t level, sl::source_location const& pos);
+///	@brief	Dumps metrics periodically into the logger in a background thread.
+///		The logger is looked up at each dump, and the dump is skipped if it has been removed.
+///	@param[in]		tag			Tag of logger to dump.
+///	@param[in]		level		Logging level.
+///	@param[in]		interval	Interval of dumps; zero stops them.
+void		set_metrics_dump(std::string const& tag, level_t level, std::chrono::milliseconds interval);
+
+namespace impl {
+
+//	Records the elapsed time of a scope at the position.
+void		record_profile(sl::source_location const& pos, std::chrono::steady_clock::duration elapsed) noexcept;
+
+}	// namespace impl
 
 #endif	// xxx_no_logging
 
@@ -642,7 +1968,7 @@ public:
 	///	@param[in]		args		More agruments.
 	///	@see			xxx_logpos
 	template<typename... Args>
-	tracer_t(logger_t& logger, sl::source_location const& pos, Args... args) :
+	tracer_t(logger_t& logger, sl::source_location const& pos, Args const&... args) :
 		tracer_t(logger, level_t::Trace, pos, args...)
 	{}
 	///	@brief	Dumps log at entering into the scope.
@@ -652,18 +1978,35 @@ public:
 	///	@param[in]		args		More agruments.
 	///	@see			xxx_logpos
 	template<typename... Args>
-	tracer_t(logger_t& logger, level_t level, sl::source_location const& pos, Args... args) :
+	tracer_t(logger_t& logger, level_t level, sl::source_location const& pos, Args const&... args) :
 		logger_{ logger },
 		pos_{ pos },
 		result_{},
-		level_{ level }
+		level_{ level },
+		active_{ logger.enabled(level) },
+		profiling_{ logger.profiling() },
+		start_{}
 	{
-		logger_.log(level, pos, ">>>", enclose(args...));
+		if(active_)
+		{
+			logger_.log(level, pos, ">>>", impl::enclosed_t<Args...>{ std::tie(args...) });
+		}
+		if(profiling_)
+		{
+			start_	= std::chrono::steady_clock::now();
+		}
 	}	
 	///	@brief	Dumps log at leaving from the scope.
 	~tracer_t()
 	{
-		logger_.log(level_, pos_, "<<<", result_);
+		if(profiling_)
+		{
+			impl::record_profile(pos_, std::chrono::steady_clock::now() - start_);
+		}
+		if(active_)
+		{
+			logger_.log(level_, pos_, "<<<", result_);
+		}
 	}
 	///	@brief	Dumps log as trace level.
 	///	@tparam			Args		arguments
@@ -671,31 +2014,55 @@ public:
 	///	@see			xxx_logpos
 	template <typename... Args>
 	void
-	trace(Args... args)
+	trace(Args const&... args)
 	{
-		logger_.log(level_, pos_, "--- ", args...);
+		if(active_)
+		{
+			logger_.log(level_, pos_, "--- ", args...);
+		}
 	}
 	///	@brief	Sets result of the method.
 	///	@param[in]		result		Result of the method.
-	template<typename T>	void	set_result(T result){	result_		=enclose(result);	}
+	template<typename T>	void	set_result(T result){	if(active_) result_	= enclose(result);	}
 private:
 	logger_t&				logger_;	///< Logger.
 	sl::source_location		pos_;		///< Position of source.
 	std::string				result_;	///< Result.
 	level_t					level_;		///< Trace level.
+	bool					active_;	///< Whether the level is enabled at entering or not.
+	bool					profiling_;	///< Whether the scope is profiled or not.
+	std::chrono::steady_clock::time_point	start_;	///< Time at entering into the scope.
 private:
 	tracer_t(tracer_t const&)						= delete;
 	tracer_t const&		operator =(tracer_t const&)	= delete;
 };
 
 ///	@overload
-template<>	inline void		tracer_t::set_result(char const* result) { result_ = result; }
+template<>	inline void		tracer_t::set_result(char const* result) { if(active_) result_ = result; }
 ///	@overload
-template<>	inline void		tracer_t::set_result(std::string const& result) { result_ = result; }
+template<>	inline void		tracer_t::set_result(std::string const& result) { if(active_) result_ = result; }
 
 #endif	// xxx_no_logging
 
 }	// namespace log
 }	// namespace xxx
 
+#if defined(xxx_no_logging)
+#define	xxx_log(logger, level, ...)		do {} while(false)
+#else	// xxx_no_logging
+///	@brief	Logging utility macro.
+///		Unlike the methods of logger_t, the arguments are not evaluated
+///		unless the @p level is enabled.
+///	@param[in]		logger		Logger.
+///	@param[in]		level		Logging level.
+///	@param[in]		...			Arguments to log.
+#define	xxx_log(logger, level, ...)	\
+	do {	\
+		if(auto& xxx_logger_{ logger }; xxx_logger_.enabled(level))	\
+		{	\
+			xxx_logger_.log(level, xxx_logpos, __VA_ARGS__);	\
+		}	\
+	} while(false)
+#endif	// xxx_no_logging
+
 #endif	// xxx_LOGGER_HXX_
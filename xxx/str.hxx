@@ -11,7 +11,15 @@
 #include <string_view>
 #include <algorithm>
 #include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <stdexcept>
+#include <charconv>
+#include <optional>
+#include <sstream>
+#include <type_traits>
+#include <vector>
 
 namespace xxx {
 
@@ -74,43 +82,386 @@ trim(std::string_view str)
 	return std::string(left_ws_itr, right_ws_itr);
 }
 
+namespace impl {
+
+//	Whether the character is an ASCII whitespace, i.e., one of " \t\n\v\f\r".
+constexpr bool
+is_ascii_space(char ch) noexcept
+{
+	return ch == ' ' || static_cast<unsigned char>(ch - '\t') <= '\r' - '\t';
+}
+
+}	// namespace impl
+
+///	@brief	Trims ASCII whitespaces of right side without copying.
+///	@notice	Unlike trim_right, it does not depend on locale.
+///	@param[in]		str		String to trim
+///	@return		Trimed view of @p str
+constexpr std::string_view
+trim_right_view(std::string_view str) noexcept
+{
+	auto	size{ str.size() };
+	while (0u < size && impl::is_ascii_space(str[size - 1u]))	--size;
+	return str.substr(0u, size);
+}
+
+///	@brief	Trims ASCII whitespaces of left side without copying.
+///	@notice	Unlike trim_left, it does not depend on locale.
+///	@param[in]		str		String to trim
+///	@return		Trimed view of @p str
+constexpr std::string_view
+trim_left_view(std::string_view str) noexcept
+{
+	std::size_t	offset{};
+	while (offset < str.size() && impl::is_ascii_space(str[offset]))	++offset;
+	return str.substr(offset);
+}
+
+///	@brief	Trims ASCII whitespaces without copying.
+///	@notice	Unlike trim, it does not depend on locale.
+///	@param[in]		str		String to trim
+///	@return		Trimed view of @p str
+constexpr std::string_view
+trim_view(std::string_view str) noexcept
+{
+	return trim_right_view(trim_left_view(str));
+}
+
+///	@brief	Set of delimiter characters for split.
+class any_of_t
+{
+public:
+	///	@brief	Constructor.
+	///	@param[in]		chars	Delimiter characters
+	constexpr explicit	any_of_t(std::string_view chars) noexcept
+	{
+		for (auto const ch : chars)
+		{
+			auto const	c{ static_cast<unsigned char>(ch) };
+			bits_[c / 64u]	|= std::uint64_t{ 1u } << (c % 64u);
+		}
+	}
+	///	@brief	Finds the first delimiter.
+	///	@param[in]		str		String to find in
+	///	@param[in]		offset	Offset to start finding
+	///	@return		Position of the delimiter or std::string_view::npos.
+	constexpr std::size_t
+	find(std::string_view str, std::size_t offset) const noexcept
+	{
+		for (; offset < str.size(); ++offset)
+		{
+			if (contains(str[offset]))	return offset;
+		}
+		return std::string_view::npos;
+	}
+	///	@brief	Whether the character is a delimiter.
+	///	@param[in]		ch		Character
+	///	@return		Whether it is a delimiter.
+	constexpr bool
+	contains(char ch) const noexcept
+	{
+		auto const	c{ static_cast<unsigned char>(ch) };
+		return (bits_[c / 64u] >> (c % 64u)) & 1u;
+	}
+	///	@brief	Gets the length of a delimiter.
+	static constexpr std::size_t	size() noexcept { return 1u; }
+private:
+	std::uint64_t	bits_[4]{};
+};
+
+///	@brief	Whether split keeps empty fields.
+enum class empty_fields_t
+{
+	Keep,		///< Keeps empty fields.
+	Skip,		///< Skips empty fields.
+};
+
+namespace impl {
+
+//	Delimiter of a character.
+class char_delimiter_t
+{
+public:
+	constexpr explicit	char_delimiter_t(char ch) noexcept : ch_{ ch } {}
+	constexpr std::size_t	find(std::string_view str, std::size_t offset) const noexcept { return str.find(ch_, offset); }
+	static constexpr std::size_t	size() noexcept { return 1u; }
+private:
+	char	ch_;
+};
+
+//	Delimiter of a string.
+class string_delimiter_t
+{
+public:
+	constexpr explicit	string_delimiter_t(std::string_view str) noexcept : str_{ str } {}
+	constexpr std::size_t	find(std::string_view str, std::size_t offset) const noexcept { return str.find(str_, offset); }
+	constexpr std::size_t	size() const noexcept { return str_.size(); }
+private:
+	std::string_view	str_;
+};
+
+}	// namespace impl
+
+///	@brief	Lazy range of fields split by delimiters.
+///		It neither copies the string nor allocates memory,
+///		so the string must outlive the range and its iterators.
+///		An empty string has no fields.
+///	@tparam		Delimiter	Delimiter, which has find(str, offset) and size().
+template<typename Delimiter>
+class split_t
+{
+public:
+	///	@brief	Forward iterator of fields.
+	class iterator
+	{
+	public:
+		using iterator_category	= std::forward_iterator_tag;
+		using value_type		= std::string_view;
+		using difference_type	= std::ptrdiff_t;
+		using pointer			= std::string_view const*;
+		using reference			= std::string_view const&;
+
+		///	@brief	Constructor of the end.
+		constexpr iterator() noexcept = default;
+		///	@brief	Constructor of the first field.
+		///	@param[in]		range	Range to iterate
+		constexpr explicit	iterator(split_t const& range) noexcept : range_{ &range }	{ next_(0u); }
+
+		constexpr reference	operator *() const noexcept	{ return field_; }
+		constexpr pointer	operator ->() const noexcept	{ return &field_; }
+		constexpr iterator&	operator ++() noexcept		{ next_(next_offset_); return *this; }
+		constexpr iterator	operator ++(int) noexcept	{ auto const it{ *this }; ++*this; return it; }
+		friend constexpr bool	operator ==(iterator const& lhs, iterator const& rhs) noexcept
+		{
+			return lhs.range_ == rhs.range_ && lhs.field_.data() == rhs.field_.data();
+		}
+		friend constexpr bool	operator !=(iterator const& lhs, iterator const& rhs) noexcept	{ return ! (lhs == rhs); }
+	private:
+		// Finds the field from the offset, or becomes the end.
+		constexpr void
+		next_(std::size_t offset) noexcept
+		{
+			auto const&	str{ range_->str_ };
+			for ( ; offset <= str.size(); )
+			{
+				auto const	found{ range_->delimiter_.find(str, offset) };
+				auto const	last{ found == std::string_view::npos ? str.size() : found };
+				field_			= str.substr(offset, last - offset);
+				next_offset_	= found == std::string_view::npos ? str.size() + 1u : found + range_->delimiter_.size();
+				if (range_->empty_fields_ == empty_fields_t::Keep || ! field_.empty())
+				{
+					return;
+				}
+				offset	= next_offset_;
+			}
+			*this	= iterator{};
+		}
+	private:
+		split_t const*		range_{};
+		std::string_view	field_{};
+		std::size_t			next_offset_{};
+	};
+	using const_iterator	= iterator;
+
+	///	@brief	Constructor.
+	///	@param[in]		str			String to split
+	///	@param[in]		delimiter	Delimiter
+	///	@param[in]		empty_fields	Whether it keeps empty fields.
+	constexpr	split_t(std::string_view str, Delimiter const& delimiter, empty_fields_t empty_fields) noexcept :
+		str_{ str }, delimiter_{ delimiter }, empty_fields_{ empty_fields } {}
+
+	///	@brief	Gets the iterator of the first field.
+	constexpr iterator	begin() const noexcept	{ return str_.empty() ? iterator{} : iterator{ *this }; }
+	///	@brief	Gets the iterator of the end.
+	constexpr iterator	end() const noexcept	{ return iterator{}; }
+private:
+	std::string_view	str_;
+	Delimiter			delimiter_;
+	empty_fields_t		empty_fields_;
+};
+
+///	@brief	Splits a string by a character.
+///	@param[in]		str			String to split
+///	@param[in]		delimiter	Delimiter character
+///	@param[in]		empty_fields	Whether it keeps empty fields.
+///	@return		Lazy range of fields
+constexpr split_t<impl::char_delimiter_t>
+split(std::string_view str, char delimiter, empty_fields_t empty_fields=empty_fields_t::Keep) noexcept
+{
+	return { str, impl::char_delimiter_t{ delimiter }, empty_fields };
+}
+
+///	@brief	Splits a string by a string.
+///	@param[in]		str			String to split
+///	@param[in]		delimiter	Delimiter string, which must not be empty.
+///	@param[in]		empty_fields	Whether it keeps empty fields.
+///	@return		Lazy range of fields
+///	@exception		std::invalid_argument	The delimiter is empty.
+inline split_t<impl::string_delimiter_t>
+split(std::string_view str, std::string_view delimiter, empty_fields_t empty_fields=empty_fields_t::Keep)
+{
+	if (delimiter.empty())
+	{
+		throw std::invalid_argument(__func__);
+	}
+	return { str, impl::string_delimiter_t{ delimiter }, empty_fields };
+}
+
+///	@brief	Splits a string by any of characters.
+///	@param[in]		str			String to split
+///	@param[in]		delimiter	Delimiter characters
+///	@param[in]		empty_fields	Whether it keeps empty fields.
+///	@return		Lazy range of fields
+constexpr split_t<any_of_t>
+split(std::string_view str, any_of_t const& delimiter, empty_fields_t empty_fields=empty_fields_t::Keep) noexcept
+{
+	return { str, delimiter, empty_fields };
+}
+
+///	@brief	Splits a string into tokens separated by ASCII whitespaces.
+///	@param[in]		str			String to split
+///	@return		Lazy range of non-empty tokens
+constexpr split_t<any_of_t>
+tokenize(std::string_view str) noexcept
+{
+	return split(str, any_of_t{ " \t\n\v\f\r" }, empty_fields_t::Skip);
+}
+
+namespace impl {
+
+///	@brief	Whether @p T is parsed by std::from_chars.
+///	@details	Character types are read as characters by streams, so they are excluded.
+template<typename T>
+constexpr bool	is_from_chars_v{ std::is_arithmetic_v<T>
+	&& ! std::is_same_v<T, bool> && ! std::is_same_v<T, char> && ! std::is_same_v<T, signed char> && ! std::is_same_v<T, unsigned char>
+	&& ! std::is_same_v<T, wchar_t> && ! std::is_same_v<T, char16_t> && ! std::is_same_v<T, char32_t>
+#if ! defined(__cpp_lib_to_chars)
+	&& ! std::is_floating_point_v<T>
+#endif
+};
+
+///	@brief	Parses the head of the string as the type @p T.
+///	@details	It skips leading whitespaces and ignores trailing characters as well as streams do.
+///	@tparam			T		Type of parsed value
+///	@param[in]		str		String to parse
+///	@param[out]		t		Parsed value
+///	@return		The end of parsed characters, or nullptr if it fails.
+template<typename T>
+inline char const*
+parse(std::string_view str, T& t)
+{
+	auto const*	first{ str.data() };
+	auto const*	last{ str.data() + str.size() };
+	while (first != last && std::isspace(static_cast<unsigned char>(*first)))	++first;
+
+	if constexpr (is_from_chars_v<T>)
+	{
+		// from_chars accepts neither a plus sign nor negative unsigned values unlike streams.
+		if (first != last && *first == '+' && (last - first) > 1 && first[1] != '-')	++first;
+		auto const	[end, ec]{ std::from_chars(first, last, t) };
+		return ec == std::errc{} ? end : nullptr;
+	}
+	else if constexpr (std::is_same_v<T, bool>)
+	{
+		using namespace std::string_view_literals;
+		auto const	rest{ std::string_view{ first, static_cast<std::size_t>(last - first) } };
+		if (rest.substr(0, 4) == "true"sv)	{ t = true;		return first + 4; }
+		if (rest.substr(0, 5) == "false"sv)	{ t = false;	return first + 5; }
+		return nullptr;
+	}
+	else if constexpr (std::is_same_v<T, std::string>)
+	{
+		t	= std::string{ str };
+		return last;
+	}
+	else
+	{
+		std::istringstream	iss{ std::string{ str } };
+		if ( ! (iss >> t))
+		{
+			return nullptr;
+		}
+		return iss.eof() ? last : str.data() + static_cast<std::size_t>(iss.tellg());
+	}
+}
+
+}	// namespace impl
+
+///	@brief	Casts from string to the type @p T without exceptions.
+///	@details	Arithmetic types except characters and bool are parsed by std::from_chars,
+///				and the others are parsed by streams.
+///	@tparam			T		Type of returning value
+///	@param[in]		str		String to cast
+///	@return		Casted value, or nullopt if it fails.
+template<typename T>
+inline std::optional<T>
+try_lexical_cast(std::string_view str)
+{
+	if (T t{}; impl::parse(str, t))
+	{
+		return t;
+	}
+	return std::nullopt;
+}
+
 ///	@brief	Casts from string to the type @p T.
 ///	@tparam			T		Type of returning value
 ///	@param[in]		str		String to cast
 ///	@return		Casted value
+///	@exception		std::invalid_argument	It fails to cast.
 template<typename T>
 inline T
-lexical_cast(std::string const& str)
+lexical_cast(std::string_view str)
 {
-	std::istringstream	iss{ str };
-	T	t{};
-	if ( ! (iss >> t))
+	if (auto t{ try_lexical_cast<T>(str) }; t)
 	{
-		throw std::invalid_argument(__func__);
+		return *std::move(t);
 	}
-	return t;
+	throw std::invalid_argument(__func__);
 }
 
-///	@overload
-template<>
+///	@brief	Casts each field of delimited string to the type @p T without exceptions.
+///	@details	Each field must consist of the value and optional whitespaces around it.
+///	@tparam			T			Type of returning values
+///	@param[in]		str			String to cast
+///	@param[in]		delimiter	Delimiter between fields
+///	@param[out]		values		Casted values to append
+///	@return		Whether all the fields are casted. It is true for an empty string.
+template<typename T>
 inline bool
-lexical_cast(std::string const& str)
+try_lexical_cast_list(std::string_view str, char delimiter, std::vector<T>& values)
 {
-	std::istringstream	iss{ str };
-	bool	t{};
-	if ( ! (iss >> std::boolalpha >> t))
+	auto const	is_space{ [](char ch) { return std::isspace(static_cast<unsigned char>(ch)) != 0; } };
+
+	for (auto const field : split(str, delimiter))
 	{
-		throw std::invalid_argument(__func__);
+		T			t{};
+		auto const*	end{ impl::parse(field, t) };
+		if ( ! end || ! std::all_of(end, field.data() + field.size(), is_space))
+		{
+			return false;
+		}
+		values.push_back(std::move(t));
 	}
-	return t;
+	return true;
 }
 
-///	@overload
-template<>
-inline std::string
-lexical_cast(std::string const& str)
+///	@brief	Casts each field of delimited string to the type @p T.
+///	@tparam			T			Type of returning values
+///	@param[in]		str			String to cast
+///	@param[in]		delimiter	Delimiter between fields
+///	@return		Casted values
+///	@exception		std::invalid_argument	It fails to cast any field.
+template<typename T>
+inline std::vector<T>
+lexical_cast_list(std::string_view str, char delimiter=',')
 {
-	return str;
+	std::vector<T>	values;
+	if ( ! try_lexical_cast_list(str, delimiter, values))
+	{
+		throw std::invalid_argument(__func__);
+	}
+	return values;
 }
 
 }	// namespace xxx
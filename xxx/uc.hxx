@@ -14,6 +14,19 @@
 #include <vector>
 #include <algorithm>
 #include <stdexcept>
+#include <atomic>
+#include <iterator>
+
+#if ! defined(xxx_standard_cpp_only) && (defined(__x86_64__) || defined(_M_X64))
+#define xxx_uc_x86
+#include <immintrin.h>
+#if defined(_MSC_VER) && ! defined(__clang__)
+#include <intrin.h>
+#define xxx_uc_avx2
+#else
+#define xxx_uc_avx2 __attribute__((target("avx2")))
+#endif
+#endif
 
 #if defined(xxx_win32) || defined(xxx_non_utf8_mbs)
 // This implementation does not use Windows.h header of VC2019
@@ -53,10 +66,11 @@ inline constexpr bool is_u32be(char32_t ch) noexcept { return ch == 0xFEFF'0000;
 inline constexpr bool is_u32le(char32_t ch) noexcept { return ch == 0x0000'FEFF; }
 inline constexpr bool is_u32bom(char32_t ch) noexcept { return is_u32be(ch) || is_u32le(ch); }
 
-inline constexpr bool is_high_surrogate_pair(char16_t ch) noexcept { return is_valid(ch) && 0xFC00 <= ch && ch < 0xDBFF; }
-inline constexpr bool is_low_surrogate_pair(char16_t ch) noexcept { return is_valid(ch) && 0xDC00 <= ch && ch < 0xDFFF; }
+inline constexpr bool is_high_surrogate_pair(char16_t ch) noexcept { return is_valid(ch) && 0xD800 <= ch && ch <= 0xDBFF; }
+inline constexpr bool is_low_surrogate_pair(char16_t ch) noexcept { return is_valid(ch) && 0xDC00 <= ch && ch <= 0xDFFF; }
 inline constexpr bool is_surrogate_pair(char16_t ch) noexcept { return is_high_surrogate_pair(ch) || is_low_surrogate_pair(ch); }
 inline constexpr bool is_surrogate_pair(char32_t ch) noexcept { return is_valid(ch) && 0x0000'FFFF < ch; }
+inline constexpr bool is_surrogate(char32_t ch) noexcept { return 0xD800 <= ch && ch <= 0xDFFF; }
 
 enum class u8_t
 {
@@ -109,7 +123,7 @@ to_u32(std::u8string_view const &str) noexcept
 		{
 			return {0u, U'\0'};
 		}
-		ch = get_bits(str[0]) * (2 << 6) + get_bits(str[1]);
+		ch = get_bits(str[0]) * (1 << 6) + get_bits(str[1]);
 		if (ch < 0x80 || 0x0800 <= ch)
 		{
 			return {0u, U'\0'};
@@ -120,8 +134,8 @@ to_u32(std::u8string_view const &str) noexcept
 		{
 			return {0u, U'\0'};
 		}
-		ch = get_bits(str[0]) * (2 << 6 * 2) + get_bits(str[1]) * (2 << 6) + get_bits(str[2]);
-		if (ch < 0x0800 || 0x0001'0000 <= ch)
+		ch = get_bits(str[0]) * (1 << 6 * 2) + get_bits(str[1]) * (1 << 6) + get_bits(str[2]);
+		if (ch < 0x0800 || 0x0001'0000 <= ch || is_surrogate(ch))
 		{
 			return {0u, U'\0'};
 		}
@@ -131,7 +145,7 @@ to_u32(std::u8string_view const &str) noexcept
 		{
 			return {0u, U'\0'};
 		}
-		ch = get_bits(str[0]) * (2 << 6 * 3) + get_bits(str[1]) * (2 << 6 * 2) + get_bits(str[2]) * (2 << 6) + get_bits(str[3]);
+		ch = get_bits(str[0]) * (1 << 6 * 3) + get_bits(str[1]) * (1 << 6 * 2) + get_bits(str[2]) * (1 << 6) + get_bits(str[3]);
 		if (ch < 0x0001'0000 || 0x0011'0000 <= ch)
 		{
 			return {0u, U'\0'};
@@ -158,7 +172,7 @@ to_u32(std::u16string_view const &str) noexcept
 		{
 			return {0u, U'\0'};
 		}
-		return {2u, 0x0010'0000 + ((str[0] - 0xD800) * 0x0400) + (str[1] - 0xDC00)};
+		return {2u, 0x0001'0000 + ((str[0] - 0xD800) * 0x0400) + (str[1] - 0xDC00)};
 	}
 	if (is_low_surrogate_pair(str[0]))
 	{
@@ -173,14 +187,14 @@ to_u32(std::u16string_view const &str) noexcept
 inline constexpr std::tuple<std::size_t, std::array<char16_t, 3u>>
 to_u16(char32_t ch) noexcept
 {
-	if (!is_valid(ch))
+	if (!is_valid(ch) || is_surrogate(ch))
 	{
 		return {0u, {u'\0', u'\0', u'\0'}};
 	}
 	else if (is_surrogate_pair(ch))
 	{
-		auto const high{static_cast<char16_t>((ch - 0x0010'0000) / 0x400 + 0xD800)};
-		auto const low{static_cast<char16_t>((ch - 0x0010'0000) % 0x400 + 0xDC00)};
+		auto const high{static_cast<char16_t>((ch - 0x0001'0000) / 0x400 + 0xD800)};
+		auto const low{static_cast<char16_t>((ch - 0x0001'0000) % 0x400 + 0xDC00)};
 		return {2u, {high, low, u'\0'}};
 	}
 	else
@@ -198,15 +212,15 @@ to_u8(char32_t ch) noexcept
 	}
 	else if (0x80 <= ch && ch < 0x0800)
 	{
-		return {2u, {static_cast<char8_t>(((ch / (2 << 6 * 1)) & 0x0b0001'1111) | 0b1100'0000), static_cast<char8_t>((ch & 0x0b0011'1111) | 0b1000'0000), u8'\0', u8'\0', u8'\0'}};
+		return {2u, {static_cast<char8_t>(((ch / (1 << 6 * 1)) & 0b0001'1111) | 0b1100'0000), static_cast<char8_t>((ch & 0b0011'1111) | 0b1000'0000), u8'\0', u8'\0', u8'\0'}};
 	}
-	else if (0x0800 <= ch && ch < 0x0001'0000)
+	else if (0x0800 <= ch && ch < 0x0001'0000 && ! is_surrogate(ch))
 	{
-		return {3u, {static_cast<char8_t>(((ch / (2 << 6 * 2)) & 0x0b0000'1111) | 0b1110'0000), static_cast<char8_t>(((ch / (2 << 6 * 1)) & 0x0b0011'1111) | 0b1000'0000), static_cast<char8_t>((ch & 0x0b0011'1111) | 0b1000'0000), u8'\0', u8'\0'}};
+		return {3u, {static_cast<char8_t>(((ch / (1 << 6 * 2)) & 0b0000'1111) | 0b1110'0000), static_cast<char8_t>(((ch / (1 << 6 * 1)) & 0b0011'1111) | 0b1000'0000), static_cast<char8_t>((ch & 0b0011'1111) | 0b1000'0000), u8'\0', u8'\0'}};
 	}
 	else if (0x0001'0000 <= ch && ch < 0x0011'0000)
 	{
-		return {4u, {static_cast<char8_t>(((ch / (2 << 6 * 3)) & 0x0b0000'0111) | 0b1111'0000), static_cast<char8_t>(((ch / (2 << 6 * 2)) & 0x0b0011'1111) | 0b1000'0000), static_cast<char8_t>(((ch / (2 << 6 * 1)) & 0x0b0011'1111) | 0b1000'0000), static_cast<char8_t>((ch & 0x0b0011'1111) | 0b1000'0000), u8'\0'}};
+		return {4u, {static_cast<char8_t>(((ch / (1 << 6 * 3)) & 0b0000'0111) | 0b1111'0000), static_cast<char8_t>(((ch / (1 << 6 * 2)) & 0b0011'1111) | 0b1000'0000), static_cast<char8_t>(((ch / (1 << 6 * 1)) & 0b0011'1111) | 0b1000'0000), static_cast<char8_t>((ch & 0b0011'1111) | 0b1000'0000), u8'\0'}};
 	}
 	else
 	{
@@ -216,41 +230,706 @@ to_u8(char32_t ch) noexcept
 
 // ===========================================================================
 
-inline std::u32string
-to_u32string(std::u8string_view const &str)
+///	@brief	Instruction sets of kernels for validation and conversion.
+enum class simd_t
+{
+	Scalar,		///< Portable C++ only.
+	SSE2,		///< SSE2.
+	AVX2,		///< AVX2.
+};
+
+namespace impl {
+
+//	Kernels for validation and conversion.
+//	Each conversion kernel converts the longest prefix which is free from special cases,
+//	and returns the number of converted code units.
+struct kernels_t
+{
+	bool		(*validate)(char8_t const*, std::size_t) noexcept;					//< Validates UTF-8.
+	std::size_t	(*ascii_to_u16)(char8_t const*, std::size_t, char16_t*) noexcept;	//< Widens ASCII.
+	std::size_t	(*ascii_to_u32)(char8_t const*, std::size_t, char32_t*) noexcept;	//< Widens ASCII.
+	std::size_t	(*bmp_to_u32)(char16_t const*, std::size_t, char32_t*) noexcept;	//< Widens UTF-16 except surrogates.
+	std::size_t	(*bmp_to_u16)(char32_t const*, std::size_t, char16_t*) noexcept;	//< Narrows BMP except surrogates.
+	std::size_t	(*u16_to_ascii)(char16_t const*, std::size_t, char8_t*) noexcept;	//< Narrows ASCII.
+	std::size_t	(*u32_to_ascii)(char32_t const*, std::size_t, char8_t*) noexcept;	//< Narrows ASCII.
+};
+
+// ---------------------------------------------------------------------------
+// Scalar kernels, which also process the rest of the vectorized kernels.
+
+inline std::size_t
+ascii_prefix_scalar(char8_t const* src, std::size_t size) noexcept
 {
-	std::vector<char32_t> buffer;
-	buffer.reserve(str.length() + 1);
-	for (std::size_t n = 0u; n < str.length();)
+	std::size_t n{};
+	while (n < size && src[n] < 0x80)
 	{
-		auto [length, ch] = to_u32(str.substr(n));
+		++n;
+	}
+	return n;
+}
+inline bool
+validate_scalar(char8_t const* src, std::size_t size) noexcept
+{
+	for (std::size_t n{ascii_prefix_scalar(src, size)}; n < size; n += ascii_prefix_scalar(src + n, size - n))
+	{
+		auto const [length, ch]{to_u32(std::u8string_view{src + n, size - n})};
 		if (length == 0u)
 		{
-			throw std::invalid_argument(__func__);
+			return false;
 		}
-		buffer.push_back(ch);
 		n += length;
 	}
-	buffer.push_back(U'\0');
-	return &buffer[0];
+	return true;
 }
-inline std::u32string
-to_u32string(std::u16string_view const &str)
+template <typename Dst>
+inline std::size_t
+ascii_to_scalar(char8_t const* src, std::size_t size, Dst* dst) noexcept
 {
-	std::vector<char32_t> buffer;
-	buffer.reserve(str.length() + 1);
-	for (std::size_t n = 0u; n < str.length();)
+	std::size_t n{};
+	for (; n < size && src[n] < 0x80; ++n)
 	{
-		auto [length, ch] = to_u32(str.substr(n));
+		dst[n] = src[n];
+	}
+	return n;
+}
+inline std::size_t	ascii_to_u16_scalar(char8_t const* src, std::size_t size, char16_t* dst) noexcept { return ascii_to_scalar(src, size, dst); }
+inline std::size_t	ascii_to_u32_scalar(char8_t const* src, std::size_t size, char32_t* dst) noexcept { return ascii_to_scalar(src, size, dst); }
+inline std::size_t
+bmp_to_u32_scalar(char16_t const* src, std::size_t size, char32_t* dst) noexcept
+{
+	std::size_t n{};
+	for (; n < size && ! is_surrogate(src[n]); ++n)
+	{
+		dst[n] = src[n];
+	}
+	return n;
+}
+inline std::size_t
+bmp_to_u16_scalar(char32_t const* src, std::size_t size, char16_t* dst) noexcept
+{
+	std::size_t n{};
+	for (; n < size && src[n] <= 0xFFFF && ! is_surrogate(src[n]); ++n)
+	{
+		dst[n] = static_cast<char16_t>(src[n]);
+	}
+	return n;
+}
+template <typename Src>
+inline std::size_t
+to_ascii_scalar(Src const* src, std::size_t size, char8_t* dst) noexcept
+{
+	std::size_t n{};
+	for (; n < size && src[n] < 0x80; ++n)
+	{
+		dst[n] = static_cast<char8_t>(src[n]);
+	}
+	return n;
+}
+inline std::size_t	u16_to_ascii_scalar(char16_t const* src, std::size_t size, char8_t* dst) noexcept { return to_ascii_scalar(src, size, dst); }
+inline std::size_t	u32_to_ascii_scalar(char32_t const* src, std::size_t size, char8_t* dst) noexcept { return to_ascii_scalar(src, size, dst); }
+
+inline constexpr kernels_t	scalar_kernels{
+	validate_scalar, ascii_to_u16_scalar, ascii_to_u32_scalar, bmp_to_u32_scalar, bmp_to_u16_scalar, u16_to_ascii_scalar, u32_to_ascii_scalar};
+
+#if defined(xxx_uc_x86)
+
+// ---------------------------------------------------------------------------
+// SSE2 kernels, which x86-64 always supports.
+
+inline std::size_t
+ascii_prefix_sse2(char8_t const* src, std::size_t size) noexcept
+{
+	std::size_t n{};
+	for (; n + 16u <= size; n += 16u)
+	{
+		if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + n))) != 0)
+		{
+			break;
+		}
+	}
+	return n + ascii_prefix_scalar(src + n, size - n);
+}
+inline bool
+validate_sse2(char8_t const* src, std::size_t size) noexcept
+{
+	// SSE2 lacks byte shuffle, so only ASCII runs are vectorized.
+	for (std::size_t n{ascii_prefix_sse2(src, size)}; n < size; n += ascii_prefix_sse2(src + n, size - n))
+	{
+		auto const [length, ch]{to_u32(std::u8string_view{src + n, size - n})};
 		if (length == 0u)
 		{
-			throw std::invalid_argument(__func__);
+			return false;
 		}
-		buffer.push_back(ch);
 		n += length;
 	}
-	buffer.push_back(U'\0');
-	return &buffer[0];
+	return true;
+}
+inline std::size_t
+ascii_to_u16_sse2(char8_t const* src, std::size_t size, char16_t* dst) noexcept
+{
+	auto const	zero{_mm_setzero_si128()};
+	std::size_t n{};
+	for (; n + 16u <= size; n += 16u)
+	{
+		auto const v{_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + n))};
+		if (_mm_movemask_epi8(v) != 0)
+		{
+			break;
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n), _mm_unpacklo_epi8(v, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n + 8u), _mm_unpackhi_epi8(v, zero));
+	}
+	return n + ascii_to_u16_scalar(src + n, size - n, dst + n);
+}
+inline std::size_t
+ascii_to_u32_sse2(char8_t const* src, std::size_t size, char32_t* dst) noexcept
+{
+	auto const	zero{_mm_setzero_si128()};
+	std::size_t n{};
+	for (; n + 16u <= size; n += 16u)
+	{
+		auto const v{_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + n))};
+		if (_mm_movemask_epi8(v) != 0)
+		{
+			break;
+		}
+		auto const lo{_mm_unpacklo_epi8(v, zero)};
+		auto const hi{_mm_unpackhi_epi8(v, zero)};
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n), _mm_unpacklo_epi16(lo, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n + 4u), _mm_unpackhi_epi16(lo, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n + 8u), _mm_unpacklo_epi16(hi, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n + 12u), _mm_unpackhi_epi16(hi, zero));
+	}
+	return n + ascii_to_u32_scalar(src + n, size - n, dst + n);
+}
+inline std::size_t
+bmp_to_u32_sse2(char16_t const* src, std::size_t size, char32_t* dst) noexcept
+{
+	auto const	zero{_mm_setzero_si128()};
+	auto const	mask{_mm_set1_epi16(static_cast<short>(0xF800))};
+	auto const	surrogate{_mm_set1_epi16(static_cast<short>(0xD800))};
+	std::size_t n{};
+	for (; n + 8u <= size; n += 8u)
+	{
+		auto const v{_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + n))};
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, mask), surrogate)) != 0)
+		{
+			break;
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n), _mm_unpacklo_epi16(v, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n + 4u), _mm_unpackhi_epi16(v, zero));
+	}
+	return n + bmp_to_u32_scalar(src + n, size - n, dst + n);
+}
+inline std::size_t
+bmp_to_u16_sse2(char32_t const* src, std::size_t size, char16_t* dst) noexcept
+{
+	auto const	zero{_mm_setzero_si128()};
+	auto const	mask{_mm_set1_epi32(0xF800)};
+	auto const	surrogate{_mm_set1_epi32(0xD800)};
+	auto const	bias32{_mm_set1_epi32(0x8000)};
+	auto const	bias16{_mm_set1_epi16(static_cast<short>(0x8000))};
+	std::size_t n{};
+	for (; n + 8u <= size; n += 8u)
+	{
+		auto const a{_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + n))};
+		auto const b{_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + n + 4u))};
+		auto const large{_mm_or_si128(_mm_srli_epi32(a, 16), _mm_srli_epi32(b, 16))};
+		auto const sa{_mm_cmpeq_epi32(_mm_and_si128(a, mask), surrogate)};
+		auto const sb{_mm_cmpeq_epi32(_mm_and_si128(b, mask), surrogate)};
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(large, zero)) != 0xFFFF || _mm_movemask_epi8(_mm_or_si128(sa, sb)) != 0)
+		{
+			break;
+		}
+		// Signed saturation keeps the values biased into the range of signed 16-bit.
+		auto const packed{_mm_packs_epi32(_mm_sub_epi32(a, bias32), _mm_sub_epi32(b, bias32))};
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n), _mm_add_epi16(packed, bias16));
+	}
+	return n + bmp_to_u16_scalar(src + n, size - n, dst + n);
+}
+inline std::size_t
+u16_to_ascii_sse2(char16_t const* src, std::size_t size, char8_t* dst) noexcept
+{
+	auto const	zero{_mm_setzero_si128()};
+	auto const	mask{_mm_set1_epi16(static_cast<short>(0xFF80))};
+	std::size_t n{};
+	for (; n + 16u <= size; n += 16u)
+	{
+		auto const a{_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + n))};
+		auto const b{_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + n + 8u))};
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(a, b), mask), zero)) != 0xFFFF)
+		{
+			break;
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n), _mm_packus_epi16(a, b));
+	}
+	return n + u16_to_ascii_scalar(src + n, size - n, dst + n);
+}
+inline std::size_t
+u32_to_ascii_sse2(char32_t const* src, std::size_t size, char8_t* dst) noexcept
+{
+	auto const	zero{_mm_setzero_si128()};
+	auto const	mask{_mm_set1_epi32(static_cast<int>(0xFFFF'FF80))};
+	std::size_t n{};
+	for (; n + 16u <= size; n += 16u)
+	{
+		auto const a{_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + n))};
+		auto const b{_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + n + 4u))};
+		auto const c{_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + n + 8u))};
+		auto const d{_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + n + 12u))};
+		auto const all{_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))};
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(all, mask), zero)) != 0xFFFF)
+		{
+			break;
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+	}
+	return n + u32_to_ascii_scalar(src + n, size - n, dst + n);
+}
+
+inline constexpr kernels_t	sse2_kernels{
+	validate_sse2, ascii_to_u16_sse2, ascii_to_u32_sse2, bmp_to_u32_sse2, bmp_to_u16_sse2, u16_to_ascii_sse2, u32_to_ascii_sse2};
+
+// ---------------------------------------------------------------------------
+// AVX2 kernels, which are used only if the processor supports them.
+
+//	Validates UTF-8 by lookup tables of the first two bytes of each sequence.
+//	See J. Keiser and D. Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte".
+class u8_validator_avx2_t
+{
+public:
+	xxx_uc_avx2 void
+	check(__m256i input) noexcept
+	{
+		if (_mm256_movemask_epi8(input) == 0)
+		{
+			error_			 = _mm256_or_si256(error_, incomplete_);
+			incomplete_		 = _mm256_setzero_si256();
+			previous_		 = input;
+			return;
+		}
+
+		auto const prev1{prev_(input, 1)};
+		auto const prev2{prev_(input, 2)};
+		auto const prev3{prev_(input, 3)};
+
+		// Flags of errors by the first byte and the second byte.
+		constexpr char TooShort{1 << 0};
+		constexpr char TooLong{1 << 1};
+		constexpr char Overlong3{1 << 2};
+		constexpr char TooLarge{1 << 3};
+		constexpr char Surrogate{1 << 4};
+		constexpr char Overlong2{1 << 5};
+		constexpr char TooLarge1000{1 << 6};
+		constexpr char Overlong4{1 << 6};
+		constexpr char TwoConts{static_cast<char>(1 << 7)};
+		constexpr char Carry{TooShort | TooLong | TwoConts};
+
+		auto const low4{_mm256_set1_epi8(0x0F)};
+		auto const byte1_high{lookup_(_mm256_and_si256(_mm256_srli_epi16(prev1, 4), low4),
+			TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong,
+			TwoConts, TwoConts, TwoConts, TwoConts,
+			TooShort | Overlong2,
+			TooShort,
+			TooShort | Overlong3 | Surrogate,
+			TooShort | TooLarge | TooLarge1000 | Overlong4)};
+		auto const byte1_low{lookup_(_mm256_and_si256(prev1, low4),
+			Carry | Overlong3 | Overlong2 | Overlong4,
+			Carry | Overlong2,
+			Carry,
+			Carry,
+			Carry | TooLarge,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000 | Surrogate,
+			Carry | TooLarge | TooLarge1000,
+			Carry | TooLarge | TooLarge1000)};
+		auto const byte2_high{lookup_(_mm256_and_si256(_mm256_srli_epi16(input, 4), low4),
+			TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort,
+			TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge1000 | Overlong4,
+			TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge,
+			TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+			TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+			TooShort, TooShort, TooShort, TooShort)};
+		auto const special{_mm256_and_si256(_mm256_and_si256(byte1_high, byte1_low), byte2_high)};
+
+		// The third and fourth bytes must be continuations.
+		auto const third{_mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0b1110'0000 - 1)))};
+		auto const fourth{_mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0b1111'0000 - 1)))};
+		auto const must23{_mm256_cmpgt_epi8(_mm256_or_si256(third, fourth), _mm256_setzero_si256())};
+		auto const must23_80{_mm256_and_si256(must23, _mm256_set1_epi8(TwoConts))};
+
+		error_		= _mm256_or_si256(error_, _mm256_xor_si256(must23_80, special));
+		incomplete_ = _mm256_subs_epu8(input, _mm256_setr_epi8(
+			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+			static_cast<char>(0b1111'0000 - 1), static_cast<char>(0b1110'0000 - 1), static_cast<char>(0b1100'0000 - 1)));
+		previous_ = input;
+	}
+	xxx_uc_avx2 bool
+	valid() const noexcept
+	{
+		auto const error{_mm256_or_si256(error_, incomplete_)};
+		return _mm256_testz_si256(error, error) != 0;
+	}
+
+	xxx_uc_avx2
+	u8_validator_avx2_t() noexcept : error_{_mm256_setzero_si256()}, incomplete_{_mm256_setzero_si256()}, previous_{_mm256_setzero_si256()} {}
+
+private:
+	xxx_uc_avx2 __m256i
+	prev_(__m256i input, int n) const noexcept
+	{
+		auto const crossed{_mm256_permute2x128_si256(previous_, input, 0x21)};
+		switch (n)
+		{
+		case 1:		return _mm256_alignr_epi8(input, crossed, 16 - 1);
+		case 2:		return _mm256_alignr_epi8(input, crossed, 16 - 2);
+		default:	return _mm256_alignr_epi8(input, crossed, 16 - 3);
+		}
+	}
+	template <typename... Args>
+	xxx_uc_avx2 static __m256i
+	lookup_(__m256i index, Args... table) noexcept
+	{
+		return _mm256_shuffle_epi8(_mm256_setr_epi8(table..., table...), index);
+	}
+
+private:
+	__m256i error_;			//< Errors.
+	__m256i incomplete_;	//< Incomplete sequence at the end of the previous block.
+	__m256i previous_;		//< Previous block.
+};
+
+xxx_uc_avx2 inline bool
+validate_avx2(char8_t const* src, std::size_t size) noexcept
+{
+	u8_validator_avx2_t validator;
+	std::size_t			n{};
+	for (; n + 32u <= size; n += 32u)
+	{
+		validator.check(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + n)));
+	}
+	if (n < size)
+	{
+		// Padding of ASCII terminates a truncated sequence as an error.
+		alignas(32) char8_t rest[32]{};
+		std::copy(src + n, src + size, rest);
+		validator.check(_mm256_load_si256(reinterpret_cast<__m256i const*>(rest)));
+	}
+	return validator.valid();
+}
+xxx_uc_avx2 inline std::size_t
+ascii_to_u16_avx2(char8_t const* src, std::size_t size, char16_t* dst) noexcept
+{
+	std::size_t n{};
+	for (; n + 32u <= size; n += 32u)
+	{
+		auto const v{_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + n))};
+		if (_mm256_movemask_epi8(v) != 0)
+		{
+			break;
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + n), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + n + 16u), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+	}
+	return n + ascii_to_u16_sse2(src + n, size - n, dst + n);
+}
+xxx_uc_avx2 inline std::size_t
+ascii_to_u32_avx2(char8_t const* src, std::size_t size, char32_t* dst) noexcept
+{
+	std::size_t n{};
+	for (; n + 32u <= size; n += 32u)
+	{
+		auto const v{_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + n))};
+		if (_mm256_movemask_epi8(v) != 0)
+		{
+			break;
+		}
+		auto const lo{_mm256_castsi256_si128(v)};
+		auto const hi{_mm256_extracti128_si256(v, 1)};
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + n), _mm256_cvtepu8_epi32(lo));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + n + 8u), _mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + n + 16u), _mm256_cvtepu8_epi32(hi));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + n + 24u), _mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)));
+	}
+	return n + ascii_to_u32_sse2(src + n, size - n, dst + n);
+}
+xxx_uc_avx2 inline std::size_t
+bmp_to_u32_avx2(char16_t const* src, std::size_t size, char32_t* dst) noexcept
+{
+	auto const	mask{_mm256_set1_epi16(static_cast<short>(0xF800))};
+	auto const	surrogate{_mm256_set1_epi16(static_cast<short>(0xD800))};
+	std::size_t n{};
+	for (; n + 16u <= size; n += 16u)
+	{
+		auto const v{_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + n))};
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(v, mask), surrogate)) != 0)
+		{
+			break;
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + n), _mm256_cvtepu16_epi32(_mm256_castsi256_si128(v)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + n + 8u), _mm256_cvtepu16_epi32(_mm256_extracti128_si256(v, 1)));
+	}
+	return n + bmp_to_u32_sse2(src + n, size - n, dst + n);
+}
+xxx_uc_avx2 inline std::size_t
+bmp_to_u16_avx2(char32_t const* src, std::size_t size, char16_t* dst) noexcept
+{
+	auto const	mask{_mm256_set1_epi32(0xF800)};
+	auto const	surrogate{_mm256_set1_epi32(0xD800)};
+	std::size_t n{};
+	for (; n + 16u <= size; n += 16u)
+	{
+		auto const a{_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + n))};
+		auto const b{_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + n + 8u))};
+		auto const large{_mm256_or_si256(_mm256_srli_epi32(a, 16), _mm256_srli_epi32(b, 16))};
+		auto const sa{_mm256_cmpeq_epi32(_mm256_and_si256(a, mask), surrogate)};
+		auto const sb{_mm256_cmpeq_epi32(_mm256_and_si256(b, mask), surrogate)};
+		if (_mm256_testz_si256(large, large) == 0 || _mm256_testz_si256(_mm256_or_si256(sa, sb), _mm256_or_si256(sa, sb)) == 0)
+		{
+			break;
+		}
+		// Packing works in each 128-bit lane.
+		auto const packed{_mm256_packus_epi32(a, b)};
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + n), _mm256_permute4x64_epi64(packed, 0b11'01'10'00));
+	}
+	return n + bmp_to_u16_sse2(src + n, size - n, dst + n);
+}
+xxx_uc_avx2 inline std::size_t
+u16_to_ascii_avx2(char16_t const* src, std::size_t size, char8_t* dst) noexcept
+{
+	auto const	mask{_mm256_set1_epi16(static_cast<short>(0xFF80))};
+	std::size_t n{};
+	for (; n + 32u <= size; n += 32u)
+	{
+		auto const a{_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + n))};
+		auto const b{_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + n + 16u))};
+		if (_mm256_testz_si256(_mm256_or_si256(a, b), mask) == 0)
+		{
+			break;
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + n), _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0b11'01'10'00));
+	}
+	return n + u16_to_ascii_sse2(src + n, size - n, dst + n);
+}
+xxx_uc_avx2 inline std::size_t
+u32_to_ascii_avx2(char32_t const* src, std::size_t size, char8_t* dst) noexcept
+{
+	auto const	mask{_mm256_set1_epi32(static_cast<int>(0xFFFF'FF80))};
+	std::size_t n{};
+	for (; n + 32u <= size; n += 32u)
+	{
+		auto const a{_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + n))};
+		auto const b{_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + n + 8u))};
+		auto const c{_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + n + 16u))};
+		auto const d{_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + n + 24u))};
+		if (_mm256_testz_si256(_mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d)), mask) == 0)
+		{
+			break;
+		}
+		auto const packed{_mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d))};
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + n), _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)));
+	}
+	return n + u32_to_ascii_sse2(src + n, size - n, dst + n);
+}
+
+inline constexpr kernels_t	avx2_kernels{
+	validate_avx2, ascii_to_u16_avx2, ascii_to_u32_avx2, bmp_to_u32_avx2, bmp_to_u16_avx2, u16_to_ascii_avx2, u32_to_ascii_avx2};
+
+#endif // xxx_uc_x86
+
+inline std::atomic<kernels_t const*>	kernels_s{nullptr};		//< Kernels in use.
+
+//	Gets the kernels of the instruction set.
+inline kernels_t const&
+kernels_of(simd_t simd) noexcept
+{
+	switch (simd)
+	{
+#if defined(xxx_uc_x86)
+	case simd_t::AVX2:	return avx2_kernels;
+	case simd_t::SSE2:	return sse2_kernels;
+#endif
+	case simd_t::Scalar:	[[fallthrough]];
+	default:				return scalar_kernels;
+	}
+}
+
+} // namespace impl
+
+///	@brief	Gets the best instruction set which the processor supports.
+///	@return		Instruction set.
+inline simd_t
+supported_simd() noexcept
+{
+#if defined(xxx_uc_x86)
+#if defined(_MSC_VER) && ! defined(__clang__)
+	int info[4]{};
+	__cpuid(info, 0);
+	auto const max{info[0]};
+	__cpuid(info, 1);
+	auto const osxsave{(info[2] & (1 << 27)) != 0};
+	__cpuidex(info, 7, 0);
+	auto const avx2{7 <= max && (info[1] & (1 << 5)) != 0};
+	if (avx2 && osxsave && (_xgetbv(0) & 0x6) == 0x6)
+	{
+		return simd_t::AVX2;
+	}
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		return simd_t::AVX2;
+	}
+#endif
+	return simd_t::SSE2;
+#else
+	return simd_t::Scalar;
+#endif
+}
+
+///	@brief	Gets the instruction set in use.
+///	@return		Instruction set.
+inline simd_t
+simd() noexcept
+{
+	auto const kernels{impl::kernels_s.load(std::memory_order_relaxed)};
+	if (kernels == nullptr)
+	{
+		return supported_simd();
+	}
+#if defined(xxx_uc_x86)
+	if (kernels == &impl::avx2_kernels) return simd_t::AVX2;
+	if (kernels == &impl::sse2_kernels) return simd_t::SSE2;
+#endif
+	return simd_t::Scalar;
+}
+
+///	@brief	Sets the instruction set to use, e.g., to compare results.
+///		The best one is selected unless it is set.
+///	@param[in]	simd	Instruction set.
+///	@exception	std::invalid_argument	The processor does not support the instruction set.
+inline void
+set_simd(simd_t simd)
+{
+	if (static_cast<int>(supported_simd()) < static_cast<int>(simd))
+	{
+		throw std::invalid_argument(__func__);
+	}
+	impl::kernels_s.store(&impl::kernels_of(simd), std::memory_order_relaxed);
+}
+
+namespace impl {
+
+inline kernels_t const&
+kernels() noexcept
+{
+	auto kernels{kernels_s.load(std::memory_order_relaxed)};
+	if (kernels == nullptr)
+	{
+		kernels = &kernels_of(supported_simd());
+		kernels_s.store(kernels, std::memory_order_relaxed);
+	}
+	return *kernels;
+}
+
+//	Decodes a code point of valid UTF-8 without checks.
+//	@param[in]		src		Valid UTF-8.
+//	@param[in,out]	n		Position, which is advanced to the next code point.
+//	@return		Code point.
+inline char32_t
+decode_valid(char8_t const* src, std::size_t& n) noexcept
+{
+	char32_t const c0{src[n]};
+	if (c0 < 0b1110'0000)
+	{
+		auto const ch{((c0 & 0b0001'1111) << 6) | (src[n + 1] & 0b0011'1111)};
+		n += 2u;
+		return ch;
+	}
+	else if (c0 < 0b1111'0000)
+	{
+		auto const ch{((c0 & 0b0000'1111) << 12) | ((src[n + 1] & 0b0011'1111) << 6) | (src[n + 2] & 0b0011'1111)};
+		n += 3u;
+		return ch;
+	}
+	else
+	{
+		auto const ch{((c0 & 0b0000'0111) << 18) | ((src[n + 1] & 0b0011'1111) << 12) | ((src[n + 2] & 0b0011'1111) << 6) | (src[n + 3] & 0b0011'1111)};
+		n += 4u;
+		return ch;
+	}
+}
+
+} // namespace impl
+
+///	@brief	Validates UTF-8.
+///	@param[in]	str		String.
+///	@return		If the @p str is valid UTF-8, it returns true; otherwise, it returns false.
+inline bool
+is_valid(std::u8string_view const &str) noexcept
+{
+	return impl::kernels().validate(str.data(), str.size());
+}
+
+inline std::u32string
+to_u32string(std::u8string_view const &str)
+{
+	auto const& kernels{impl::kernels()};
+	if (!kernels.validate(str.data(), str.size()))
+	{
+		throw std::invalid_argument(__func__);
+	}
+	std::u32string buffer(str.length(), U'\0');
+	auto const	   src{str.data()};
+	auto const	   dst{buffer.data()};
+	std::size_t	   m{};
+	for (std::size_t n{}; n < str.length();)
+	{
+		auto const ascii{kernels.ascii_to_u32(src + n, str.length() - n, dst + m)};
+		n += ascii;
+		m += ascii;
+		while (n < str.length() && 0x80 <= src[n])
+		{
+			dst[m++] = impl::decode_valid(src, n);
+		}
+	}
+	buffer.resize(m);
+	return buffer;
+}
+inline std::u32string
+to_u32string(std::u16string_view const &str)
+{
+	auto const& kernels{impl::kernels()};
+	std::u32string buffer(str.length(), U'\0');
+	auto const	   src{str.data()};
+	auto const	   dst{buffer.data()};
+	std::size_t	   m{};
+	for (std::size_t n{}; n < str.length();)
+	{
+		auto const bmp{kernels.bmp_to_u32(src + n, str.length() - n, dst + m)};
+		n += bmp;
+		m += bmp;
+		if (n < str.length())
+		{
+			auto const [length, ch]{to_u32(str.substr(n))};
+			if (length == 0u)
+			{
+				throw std::invalid_argument(__func__);
+			}
+			dst[m++] = ch;
+			n += length;
+		}
+	}
+	buffer.resize(m);
+	return buffer;
 }
 inline std::u32string
 to_u32string(std::u32string_view const &str)
@@ -261,27 +940,61 @@ to_u32string(std::u32string_view const &str)
 inline std::u16string
 to_u16string(std::u32string_view const &str)
 {
-	std::vector<char16_t> buffer;
-	buffer.reserve(str.length() * 2 + 1);
-	for (auto const ch : str)
+	auto const& kernels{impl::kernels()};
+	std::u16string buffer(str.length() * 2u, u'\0');
+	auto const	   src{str.data()};
+	auto const	   dst{buffer.data()};
+	std::size_t	   m{};
+	for (std::size_t n{}; n < str.length();)
 	{
-		auto [length, s] = to_u16(ch);
-		if (length == 0u)
+		auto const bmp{kernels.bmp_to_u16(src + n, str.length() - n, dst + m)};
+		n += bmp;
+		m += bmp;
+		if (n < str.length())
 		{
-			throw std::invalid_argument(__func__);
-		}
-		for (auto itr{std::cbegin(s)}, end{std::cend(s)}; itr != end && *itr != u'\0'; ++itr)
-		{
-			buffer.push_back(*itr);
+			auto const [length, s]{to_u16(src[n])};
+			if (length == 0u)
+			{
+				throw std::invalid_argument(__func__);
+			}
+			for (std::size_t i{}; i < length; ++i)
+			{
+				dst[m++] = s[i];
+			}
+			++n;
 		}
 	}
-	buffer.push_back(U'\0');
-	return &buffer[0];
+	buffer.resize(m);
+	return buffer;
 }
 inline std::u16string
 to_u16string(std::u8string_view const &str)
 {
-	return to_u16string(to_u32string(str));
+	auto const& kernels{impl::kernels()};
+	if (!kernels.validate(str.data(), str.size()))
+	{
+		throw std::invalid_argument(__func__);
+	}
+	std::u16string buffer(str.length(), u'\0');
+	auto const	   src{str.data()};
+	auto const	   dst{buffer.data()};
+	std::size_t	   m{};
+	for (std::size_t n{}; n < str.length();)
+	{
+		auto const ascii{kernels.ascii_to_u16(src + n, str.length() - n, dst + m)};
+		n += ascii;
+		m += ascii;
+		while (n < str.length() && 0x80 <= src[n])
+		{
+			auto const [length, s]{to_u16(impl::decode_valid(src, n))};
+			for (std::size_t i{}; i < length; ++i)
+			{
+				dst[m++] = s[i];
+			}
+		}
+	}
+	buffer.resize(m);
+	return buffer;
 }
 inline std::u16string
 to_u16string(std::u16string_view const &str)
@@ -292,22 +1005,32 @@ to_u16string(std::u16string_view const &str)
 inline std::u8string
 to_u8string(std::u32string_view const &str)
 {
-	std::vector<char8_t> buffer;
-	buffer.reserve(str.length() * 4 + 1);
-	for (auto const &ch : str)
+	auto const& kernels{impl::kernels()};
+	std::u8string buffer(str.length() * 4u, u8'\0');
+	auto const	  src{str.data()};
+	auto const	  dst{buffer.data()};
+	std::size_t	  m{};
+	for (std::size_t n{}; n < str.length();)
 	{
-		auto [length, s] = to_u8(ch);
-		if (length == 0u)
+		auto const ascii{kernels.u32_to_ascii(src + n, str.length() - n, dst + m)};
+		n += ascii;
+		m += ascii;
+		while (n < str.length() && 0x80 <= src[n])
 		{
-			throw std::invalid_argument(__func__);
-		}
-		for (auto itr{std::cbegin(s)}, end{std::cend(s)}; itr != end && *itr != u8'\0'; ++itr)
-		{
-			buffer.push_back(*itr);
+			auto const [length, s]{to_u8(src[n])};
+			if (length == 0u)
+			{
+				throw std::invalid_argument(__func__);
+			}
+			for (std::size_t i{}; i < length; ++i)
+			{
+				dst[m++] = s[i];
+			}
+			++n;
 		}
 	}
-	buffer.push_back(u8'\0');
-	return &buffer[0];
+	buffer.resize(m);
+	return buffer;
 }
 
 inline std::u8string
@@ -318,10 +1041,399 @@ to_u8string(std::u8string_view const &str)
 inline std::u8string
 to_u8string(std::u16string_view const &str)
 {
-	auto const s32{to_u32string(str)};
-	return to_u8string(s32);
+	auto const& kernels{impl::kernels()};
+	std::u8string buffer(str.length() * 3u, u8'\0');
+	auto const	  src{str.data()};
+	auto const	  dst{buffer.data()};
+	std::size_t	  m{};
+	for (std::size_t n{}; n < str.length();)
+	{
+		auto const ascii{kernels.u16_to_ascii(src + n, str.length() - n, dst + m)};
+		n += ascii;
+		m += ascii;
+		while (n < str.length() && 0x80 <= src[n])
+		{
+			auto const [length, ch]{to_u32(str.substr(n))};
+			if (length == 0u)
+			{
+				throw std::invalid_argument(__func__);
+			}
+			auto const [size, s]{to_u8(ch)};
+			for (std::size_t i{}; i < size; ++i)
+			{
+				dst[m++] = s[i];
+			}
+			n += length;
+		}
+	}
+	buffer.resize(m);
+	return buffer;
 }
 
+// ===========================================================================
+
+///	@brief	Policy for invalid sequences of incremental transcoding.
+enum class error_policy_t
+{
+	Throw,		///< Throws transcode_error_t, which is std::invalid_argument.
+	Replace,	///< Replaces each maximal invalid subpart with U+FFFD.
+	Skip,		///< Skips invalid sequences.
+};
+
+namespace impl {
+
+//	Status of decoding a code point.
+enum class decoded_t
+{
+	Valid,		//< Valid sequence.
+	Incomplete,	//< Valid but incomplete sequence at the end of input.
+	Invalid,	//< Invalid sequence.
+};
+
+//	Decodes a code point.
+//	If the sequence is invalid, its length is the length of the maximal subpart to replace.
+//	@param[in]	src		Code units.
+//	@param[in]	size	Number of code units, which must not be zero.
+//	@return		Status, length of the sequence, and code point.
+inline std::tuple<decoded_t, std::size_t, char32_t>
+decode(char8_t const* src, std::size_t size) noexcept
+{
+	auto const c0{src[0]};
+	if (c0 < 0x80)
+	{
+		return {decoded_t::Valid, 1u, c0};
+	}
+
+	// The second byte is limited to avoid overlong forms, surrogates, and too large code points.
+	std::size_t length;
+	char8_t		low{0x80}, high{0xBF};
+	char32_t	ch;
+	if (0xC2 <= c0 && c0 <= 0xDF)		{ length = 2u; ch = c0 & 0b0001'1111; }
+	else if (0xE0 <= c0 && c0 <= 0xEF)	{ length = 3u; ch = c0 & 0b0000'1111; low = c0 == 0xE0 ? 0xA0 : 0x80; high = c0 == 0xED ? 0x9F : 0xBF; }
+	else if (0xF0 <= c0 && c0 <= 0xF4)	{ length = 4u; ch = c0 & 0b0000'0111; low = c0 == 0xF0 ? 0x90 : 0x80; high = c0 == 0xF4 ? 0x8F : 0xBF; }
+	else								{ return {decoded_t::Invalid, 1u, U'\0'}; }
+
+	for (std::size_t n{1u}; n < length; ++n)
+	{
+		if (size <= n)
+		{
+			return {decoded_t::Incomplete, n, U'\0'};
+		}
+		if (src[n] < low || high < src[n])
+		{
+			return {decoded_t::Invalid, n, U'\0'};
+		}
+		ch	= ch * (1 << 6) + (src[n] & 0b0011'1111);
+		low = 0x80;
+		high = 0xBF;
+	}
+	return {decoded_t::Valid, length, ch};
+}
+inline std::tuple<decoded_t, std::size_t, char32_t>
+decode(char16_t const* src, std::size_t size) noexcept
+{
+	if (is_high_surrogate_pair(src[0]))
+	{
+		if (size < 2u)
+		{
+			return {decoded_t::Incomplete, 1u, U'\0'};
+		}
+		if (!is_low_surrogate_pair(src[1]))
+		{
+			return {decoded_t::Invalid, 1u, U'\0'};
+		}
+		return {decoded_t::Valid, 2u, 0x0001'0000 + ((src[0] - 0xD800) * 0x0400) + (src[1] - 0xDC00)};
+	}
+	if (is_low_surrogate_pair(src[0]))
+	{
+		return {decoded_t::Invalid, 1u, U'\0'};
+	}
+	return {decoded_t::Valid, 1u, src[0]};
+}
+inline std::tuple<decoded_t, std::size_t, char32_t>
+decode(char32_t const* src, std::size_t) noexcept
+{
+	if (!is_valid(src[0]) || is_surrogate(src[0]))
+	{
+		return {decoded_t::Invalid, 1u, U'\0'};
+	}
+	return {decoded_t::Valid, 1u, src[0]};
+}
+
+//	Encodes a valid code point.
+//	@param[in]	ch		Code point.
+//	@param[out]	dst		Code units, which must have room for a code point.
+//	@return		Number of code units.
+inline std::size_t
+encode(char32_t ch, char8_t* dst) noexcept
+{
+	auto const [length, s]{to_u8(ch)};
+	std::copy_n(std::cbegin(s), length, dst);
+	return length;
+}
+inline std::size_t
+encode(char32_t ch, char16_t* dst) noexcept
+{
+	auto const [length, s]{to_u16(ch)};
+	std::copy_n(std::cbegin(s), length, dst);
+	return length;
+}
+inline std::size_t
+encode(char32_t ch, char32_t* dst) noexcept
+{
+	*dst = ch;
+	return 1u;
+}
+
+} // namespace impl
+
+///	@brief	Exception of an invalid sequence of incremental transcoding under error_policy_t::Throw.
+///		The input before the invalid sequence has been converted, and the maximal invalid subpart has been consumed,
+///		so that the transcoder can continue with the rest of the input.
+class transcode_error_t : public std::invalid_argument
+{
+public:
+	///	@brief	Gets the number of consumed code units of the input, including the invalid subpart.
+	///	@return		Number of code units.
+	std::size_t	consumed() const noexcept { return consumed_; }
+	///	@brief	Gets the number of produced code units of the output before the invalid subpart.
+	///	@return		Number of code units.
+	std::size_t	produced() const noexcept { return produced_; }
+
+	///	@brief	Constructor.
+	///	@param[in]	consumed	Number of consumed code units of the input.
+	///	@param[in]	produced	Number of produced code units of the output.
+	transcode_error_t(std::size_t consumed, std::size_t produced) : std::invalid_argument{"transcoder_t"}, consumed_{consumed}, produced_{produced} {}
+
+private:
+	std::size_t consumed_;	//< Number of consumed code units of the input.
+	std::size_t produced_;	//< Number of produced code units of the output.
+};
+
+///	@brief	Incremental transcoder between UTF-8, UTF-16, and UTF-32.
+///		It accepts arbitrary chunk boundaries of input;
+///		a partial sequence at the end of a chunk is carried over to the next chunk.
+///		It never allocates memory.
+///	@tparam		From	Code unit of input, i.e., char8_t, char16_t, or char32_t.
+///	@tparam		To		Code unit of output, i.e., char8_t, char16_t, or char32_t.
+template <typename From, typename To>
+class transcoder_t
+{
+public:
+	///	@brief	Maximum number of code units of output per code point.
+	static constexpr std::size_t max_units{4u / sizeof(To)};
+
+	///	@brief	Converts a chunk of input into a buffer.
+	///		It stops at a code point which the buffer has no room for,
+	///		so that the rest of the input can be converted again with another buffer.
+	///	@param[in]	input	Chunk of input.
+	///	@param[out]	output	Buffer of output.
+	///	@param[in]	size	Size of the buffer.
+	///	@return		The numbers of consumed code units of the input and produced code units of the output.
+	///	@exception	transcode_error_t	The input is invalid under error_policy_t::Throw;
+	///				it has the numbers of code units consumed through the invalid subpart and produced before it.
+	std::tuple<std::size_t, std::size_t>
+	convert(std::basic_string_view<From> const& input, To* output, std::size_t size)
+	{
+		std::size_t n{}, m{};
+		if (0u < pending_size_)
+		{
+			auto const [resumed, consumed]{resume_(input, output, size, m)};
+			if (!resumed)
+			{
+				return {consumed, m};
+			}
+			n = consumed;
+		}
+		while (n < input.size())
+		{
+			auto const fast{fast_(input.data() + n, std::min(input.size() - n, size - m), output + m)};
+			n += fast;
+			m += fast;
+			if (n == input.size())
+			{
+				break;
+			}
+
+			auto const [status, length, ch]{impl::decode(input.data() + n, input.size() - n)};
+			if (status == decoded_t::Incomplete)
+			{
+				std::copy(input.data() + n, input.data() + input.size(), pending_);
+				pending_size_ = input.size() - n;
+				n			  = input.size();
+				break;
+			}
+			if (status == decoded_t::Invalid && policy_ == error_policy_t::Throw)
+			{
+				throw transcode_error_t(n + length, m);
+			}
+			if (!put_(status, ch, output, size, m))
+			{
+				break;
+			}
+			n += length;
+		}
+		return {n, m};
+	}
+	///	@brief	Converts a chunk of input into an output iterator.
+	///		It consumes the whole input.
+	///	@param[in]	input	Chunk of input.
+	///	@param[out]	out		Output iterator.
+	///	@return		The numbers of consumed code units of the input and produced code units of the output,
+	///				and the output iterator after the output.
+	///	@exception	transcode_error_t	The input is invalid under error_policy_t::Throw;
+	///				the output before the invalid subpart has been written into the output iterator.
+	template <typename OutputIterator>
+	std::tuple<std::size_t, std::size_t, OutputIterator>
+	convert(std::basic_string_view<From> const& input, OutputIterator out)
+	{
+		To			buffer[256];
+		std::size_t n{}, m{};
+		do
+		{
+			try
+			{
+				auto const [consumed, produced]{convert(input.substr(n), buffer, std::size(buffer))};
+				out = std::copy_n(buffer, produced, out);
+				n += consumed;
+				m += produced;
+			}
+			catch (transcode_error_t const& e)
+			{
+				std::copy_n(buffer, e.produced(), out);
+				throw transcode_error_t(n + e.consumed(), m + e.produced());
+			}
+		} while (n < input.size());
+		return {n, m, out};
+	}
+	///	@brief	Finishes the input into a buffer.
+	///		A partial sequence carried over is treated as an invalid sequence.
+	///	@param[out]	output	Buffer of output, which should have room for max_units.
+	///	@param[in]	size	Size of the buffer.
+	///	@return		The number of produced code units of the output.
+	///	@exception	transcode_error_t	The input ends with a partial sequence under error_policy_t::Throw;
+	///				the partial sequence has been discarded.
+	std::size_t
+	finish(To* output, std::size_t size)
+	{
+		std::size_t m{};
+		if (0u < pending_size_ && policy_ == error_policy_t::Throw)
+		{
+			pending_size_ = 0u;
+			throw transcode_error_t(0u, 0u);
+		}
+		if (0u < pending_size_ && put_(decoded_t::Invalid, U'\0', output, size, m))
+		{
+			pending_size_ = 0u;
+		}
+		return m;
+	}
+	///	@brief	Finishes the input into an output iterator.
+	///		A partial sequence carried over is treated as an invalid sequence.
+	///	@param[out]	out		Output iterator.
+	///	@return		The output iterator after the output.
+	///	@exception	transcode_error_t	The input ends with a partial sequence under error_policy_t::Throw;
+	///				the partial sequence has been discarded.
+	template <typename OutputIterator>
+	OutputIterator
+	finish(OutputIterator out)
+	{
+		To buffer[max_units];
+		return std::copy_n(buffer, finish(buffer, std::size(buffer)), out);
+	}
+	///	@brief	Discards a partial sequence carried over.
+	void	reset() noexcept { pending_size_ = 0u; }
+	///	@brief	Checks whether a partial sequence is carried over or not.
+	///	@return		If a partial sequence is carried over, it returns true; otherwise, it returns false.
+	bool	pending() const noexcept { return 0u < pending_size_; }
+	///	@brief	Gets the policy for invalid sequences.
+	///	@return		Policy.
+	auto	policy() const noexcept { return policy_; }
+
+	///	@brief	Constructor.
+	///	@param[in]	policy	Policy for invalid sequences.
+	explicit transcoder_t(error_policy_t policy = error_policy_t::Throw) noexcept : policy_{policy}, pending_{}, pending_size_{} {}
+
+private:
+	using decoded_t = impl::decoded_t;
+
+	static constexpr std::size_t pending_units_{4u / sizeof(From)};
+
+	std::size_t
+	fast_(From const* src, std::size_t size, To* dst) const noexcept
+	{
+		auto const& kernels{impl::kernels()};
+		if constexpr (std::is_same_v<From, char8_t> && std::is_same_v<To, char16_t>)		{ return kernels.ascii_to_u16(src, size, dst); }
+		else if constexpr (std::is_same_v<From, char8_t> && std::is_same_v<To, char32_t>)	{ return kernels.ascii_to_u32(src, size, dst); }
+		else if constexpr (std::is_same_v<From, char16_t> && std::is_same_v<To, char32_t>)	{ return kernels.bmp_to_u32(src, size, dst); }
+		else if constexpr (std::is_same_v<From, char32_t> && std::is_same_v<To, char16_t>)	{ return kernels.bmp_to_u16(src, size, dst); }
+		else if constexpr (std::is_same_v<From, char16_t> && std::is_same_v<To, char8_t>)	{ return kernels.u16_to_ascii(src, size, dst); }
+		else if constexpr (std::is_same_v<From, char32_t> && std::is_same_v<To, char8_t>)	{ return kernels.u32_to_ascii(src, size, dst); }
+		else if constexpr (std::is_same_v<From, char8_t> && std::is_same_v<To, char8_t>)	{ return impl::ascii_to_scalar(src, size, dst); }
+		else																				{ return 0u; }
+	}
+	//	Writes a code point or handles an invalid sequence except under error_policy_t::Throw.
+	//	@return		If the buffer has no room, it returns false; otherwise, it returns true.
+	bool
+	put_(decoded_t status, char32_t ch, To* output, std::size_t size, std::size_t& m)
+	{
+		To			units[max_units];
+		std::size_t length{};
+		if (status == decoded_t::Valid)
+		{
+			length = impl::encode(ch, units);
+		}
+		else if (policy_ == error_policy_t::Replace)
+		{
+			length = impl::encode(U'\uFFFD', units);
+		}
+		if (size - m < length)
+		{
+			return false;
+		}
+		std::copy_n(units, length, output + m);
+		m += length;
+		return true;
+	}
+	//	Completes the partial sequence carried over.
+	//	@return		Whether the sequence is completed or not, and the number of consumed code units of the input.
+	std::tuple<bool, std::size_t>
+	resume_(std::basic_string_view<From> const& input, To* output, std::size_t size, std::size_t& m)
+	{
+		From		units[pending_units_];
+		auto const	taken{std::min(std::size(units) - pending_size_, input.size())};
+		std::copy_n(pending_, pending_size_, units);
+		std::copy_n(input.data(), taken, units + pending_size_);
+
+		auto const [status, length, ch]{impl::decode(units, pending_size_ + taken)};
+		if (status == decoded_t::Incomplete)
+		{
+			std::copy_n(input.data(), taken, pending_ + pending_size_);
+			pending_size_ += taken;
+			return {false, taken};
+		}
+		if (status == decoded_t::Invalid && policy_ == error_policy_t::Throw)
+		{
+			auto const consumed{length - pending_size_};
+			pending_size_ = 0u;		// the invalid subpart is not carried over any more.
+			throw transcode_error_t(consumed, m);
+		}
+		if (!put_(status, ch, output, size, m))
+		{
+			return {false, 0u};
+		}
+		// The invalid subpart never ends within the units carried over.
+		auto const consumed{length - pending_size_};
+		pending_size_ = 0u;
+		return {true, consumed};
+	}
+
+private:
+	error_policy_t	policy_;			//< Policy for invalid sequences.
+	From			pending_[pending_units_];	//< Partial sequence carried over.
+	std::size_t		pending_size_;		//< Length of the partial sequence.
+};
+
 inline std::u32string
 to_u32string(std::wstring_view const &str)
 {